@@ -0,0 +1,472 @@
+package main
+
+import (
+	"bufio"
+	"encoding/binary"
+	"fmt"
+	"io"
+	"os"
+	"path/filepath"
+	"strings"
+	"time"
+)
+
+// Columnar match output in the Arrow IPC streaming format, so analytics
+// jobs can load matches with any Arrow reader (pyarrow.ipc.open_stream,
+// arrow::ipc::RecordBatchStreamReader, ...) instead of parsing text.
+// Schema:
+//
+//	doc_id     uint32   index into the "documents" schema metadata
+//	offset     uint64   byte offset in the document
+//	length     uint32
+//	pattern_id uint32   index into the "patterns" schema metadata
+//	confidence uint8
+//	speaker    utf8     null before the first speaker label
+//
+// Every message is a FlatBuffer header followed by its body buffers, each
+// padded to 8 bytes; no dependency beyond the standard library is needed.
+
+const (
+	arrowBatchRows     = 1 << 16
+	arrowMetadataV5    = 4
+	arrowHeaderSchema  = 1
+	arrowHeaderBatch   = 3
+	arrowTypeInt       = 2
+	arrowTypeUtf8      = 5
+	arrowContinuation  = 0xFFFFFFFF
+	arrowBufferAlign   = 8
+	arrowColumnCount   = 6
+	arrowSpeakerColumn = 5
+)
+
+// fbBuilder builds a FlatBuffer back to front like the reference
+// builders: children are written before their parents, and an object is
+// referenced by its distance from the end of the buffer
+type fbBuilder struct {
+	buf        []byte
+	head       int   // buf[head:] is the buffer built so far
+	minAlign   int   // Largest alignment used
+	fields     []int // Open table's field positions; 0 = absent
+	tableStart int
+}
+
+func newFBBuilder() *fbBuilder {
+	return &fbBuilder{buf: make([]byte, 1024), head: 1024, minAlign: 1}
+}
+
+func (b *fbBuilder) size() int { return len(b.buf) - b.head }
+
+// alloc reserves n bytes in front of the buffer; they start zeroed
+// because head only moves down
+func (b *fbBuilder) alloc(n int) []byte {
+	if b.head < n {
+		used := b.size()
+		grown := make([]byte, 2*len(b.buf)+n)
+		copy(grown[len(grown)-used:], b.buf[b.head:])
+		b.buf, b.head = grown, len(grown)-used
+	}
+	b.head -= n
+	return b.buf[b.head : b.head+n]
+}
+
+// prep pads so that after extra more bytes the size is a multiple of align
+func (b *fbBuilder) prep(align, extra int) {
+	if align > b.minAlign {
+		b.minAlign = align
+	}
+	b.alloc((-(b.size() + extra)) & (align - 1))
+}
+
+func (b *fbBuilder) putUint8(v uint8) { b.prep(1, 0); b.alloc(1)[0] = v }
+func (b *fbBuilder) putUint16(v uint16) {
+	b.prep(2, 0)
+	binary.LittleEndian.PutUint16(b.alloc(2), v)
+}
+func (b *fbBuilder) putUint32(v uint32) {
+	b.prep(4, 0)
+	binary.LittleEndian.PutUint32(b.alloc(4), v)
+}
+func (b *fbBuilder) putUint64(v uint64) {
+	b.prep(8, 0)
+	binary.LittleEndian.PutUint64(b.alloc(8), v)
+}
+
+// putOffset writes a uoffset to an object built earlier
+func (b *fbBuilder) putOffset(obj int) {
+	b.prep(4, 0)
+	b.putUint32(uint32(b.size() + 4 - obj))
+}
+
+func (b *fbBuilder) createString(s string) int {
+	b.prep(4, len(s)+1)
+	b.alloc(1) // NUL terminator
+	copy(b.alloc(len(s)), s)
+	b.putUint32(uint32(len(s)))
+	return b.size()
+}
+
+// startVector is followed by the elements in reverse order, then endVector
+func (b *fbBuilder) startVector(elemSize, count, align int) {
+	b.prep(4, elemSize*count)
+	b.prep(align, elemSize*count)
+}
+
+func (b *fbBuilder) endVector(count int) int {
+	b.putUint32(uint32(count))
+	return b.size()
+}
+
+func (b *fbBuilder) offsetVector(objs []int) int {
+	b.startVector(4, len(objs), 4)
+	for i := len(objs) - 1; i >= 0; i-- {
+		b.putOffset(objs[i])
+	}
+	return b.endVector(len(objs))
+}
+
+func (b *fbBuilder) startTable(fieldCount int) {
+	b.fields = make([]int, fieldCount)
+	b.tableStart = b.size()
+}
+
+func (b *fbBuilder) addUint8(field int, v uint8)   { b.putUint8(v); b.fields[field] = b.size() }
+func (b *fbBuilder) addUint16(field int, v uint16) { b.putUint16(v); b.fields[field] = b.size() }
+func (b *fbBuilder) addUint32(field int, v uint32) { b.putUint32(v); b.fields[field] = b.size() }
+func (b *fbBuilder) addUint64(field int, v uint64) { b.putUint64(v); b.fields[field] = b.size() }
+func (b *fbBuilder) addOffset(field, obj int)      { b.putOffset(obj); b.fields[field] = b.size() }
+
+// endTable writes the table's vtable in front of it and links the two
+func (b *fbBuilder) endTable() int {
+	b.putUint32(0) // soffset to the vtable, patched below
+	table := b.size()
+	n := len(b.fields)
+	for n > 0 && b.fields[n-1] == 0 {
+		n--
+	}
+	for i := n - 1; i >= 0; i-- {
+		var at uint16
+		if b.fields[i] != 0 {
+			at = uint16(table - b.fields[i])
+		}
+		b.putUint16(at)
+	}
+	b.putUint16(uint16(table - b.tableStart))
+	b.putUint16(uint16(2 * (n + 2)))
+	binary.LittleEndian.PutUint32(b.buf[len(b.buf)-table:], uint32(b.size()-table))
+	b.fields = nil
+	return table
+}
+
+// finish writes the root offset and returns the finished buffer
+func (b *fbBuilder) finish(root int) []byte {
+	b.prep(b.minAlign, 4)
+	b.putOffset(root)
+	return b.buf[b.head:]
+}
+
+// arrowBuffer locates one body buffer
+type arrowBuffer struct {
+	offset, length int
+}
+
+// ArrowMatchWriter streams matches as Arrow record batches
+type ArrowMatchWriter struct {
+	w    *bufio.Writer
+	rows int
+
+	docID, length, patternID []uint32
+	offset                   []uint64
+	confidence               []uint8
+	speakerOffsets           []int32
+	speakerData              []byte
+	speakerValid             []byte // Validity bitmap, LSB first
+	speakerNulls             int
+
+	body    []byte
+	buffers []arrowBuffer
+	batches int
+	matches int64
+}
+
+// NewArrowMatchWriter writes the schema; documents and patterns are stored
+// newline-separated in the schema metadata so IDs can be resolved
+func NewArrowMatchWriter(w io.Writer, documents, patterns []string) (*ArrowMatchWriter, error) {
+	a := &ArrowMatchWriter{w: bufio.NewWriterSize(w, 1<<20)}
+	a.reset()
+	return a, a.writeMessage(a.schema(documents, patterns), nil)
+}
+
+func (a *ArrowMatchWriter) reset() {
+	a.rows = 0
+	a.docID, a.length, a.patternID = a.docID[:0], a.length[:0], a.patternID[:0]
+	a.offset, a.confidence = a.offset[:0], a.confidence[:0]
+	a.speakerOffsets = append(a.speakerOffsets[:0], 0)
+	a.speakerData, a.speakerValid, a.speakerNulls = a.speakerData[:0], a.speakerValid[:0], 0
+}
+
+// Append adds one match; speaker "" is written as null
+func (a *ArrowMatchWriter) Append(docID uint32, m MatchResult, speaker string) error {
+	a.docID = append(a.docID, docID)
+	a.offset = append(a.offset, m.Offset)
+	a.length = append(a.length, uint32(m.Length))
+	a.patternID = append(a.patternID, m.PatternID)
+	a.confidence = append(a.confidence, uint8(m.Confidence))
+	if a.rows%8 == 0 {
+		a.speakerValid = append(a.speakerValid, 0)
+	}
+	if speaker == "" {
+		a.speakerNulls++
+	} else {
+		a.speakerValid[a.rows/8] |= 1 << (a.rows % 8)
+		a.speakerData = append(a.speakerData, speaker...)
+	}
+	a.speakerOffsets = append(a.speakerOffsets, int32(len(a.speakerData)))
+	a.rows++
+	if a.rows == arrowBatchRows {
+		return a.Flush()
+	}
+	return nil
+}
+
+// addBuffer appends one body buffer, padded to the Arrow alignment
+func (a *ArrowMatchWriter) addBuffer(data []byte) {
+	a.buffers = append(a.buffers, arrowBuffer{offset: len(a.body), length: len(data)})
+	a.body = append(a.body, data...)
+	for len(a.body)%arrowBufferAlign != 0 {
+		a.body = append(a.body, 0)
+	}
+}
+
+func appendUint32s(dst []byte, values []uint32) []byte {
+	for _, v := range values {
+		dst = binary.LittleEndian.AppendUint32(dst, v)
+	}
+	return dst
+}
+
+// Flush writes the pending rows as one record batch
+func (a *ArrowMatchWriter) Flush() error {
+	if a.rows == 0 {
+		return nil
+	}
+	a.body, a.buffers = a.body[:0], a.buffers[:0]
+	var scratch []byte
+	column := func(values []byte) {
+		a.addBuffer(nil) // No nulls: empty validity bitmap
+		a.addBuffer(values)
+	}
+	scratch = appendUint32s(scratch[:0], a.docID)
+	column(scratch)
+	scratch = scratch[:0]
+	for _, v := range a.offset {
+		scratch = binary.LittleEndian.AppendUint64(scratch, v)
+	}
+	column(scratch)
+	column(appendUint32s(scratch[:0], a.length))
+	column(appendUint32s(scratch[:0], a.patternID))
+	column(a.confidence)
+	if a.speakerNulls > 0 {
+		a.addBuffer(a.speakerValid)
+	} else {
+		a.addBuffer(nil)
+	}
+	scratch = scratch[:0]
+	for _, v := range a.speakerOffsets {
+		scratch = binary.LittleEndian.AppendUint32(scratch, uint32(v))
+	}
+	a.addBuffer(scratch)
+	a.addBuffer(a.speakerData)
+
+	if err := a.writeMessage(a.recordBatch(), a.body); err != nil {
+		return err
+	}
+	a.batches++
+	a.matches += int64(a.rows)
+	a.reset()
+	return nil
+}
+
+// Close flushes the last batch and writes the end-of-stream marker
+func (a *ArrowMatchWriter) Close() error {
+	if err := a.Flush(); err != nil {
+		return err
+	}
+	var eos [8]byte
+	binary.LittleEndian.PutUint32(eos[:], arrowContinuation)
+	if _, err := a.w.Write(eos[:]); err != nil {
+		return err
+	}
+	return a.w.Flush()
+}
+
+// writeMessage frames an encapsulated IPC message: continuation marker,
+// padded metadata length, FlatBuffer Message, body
+func (a *ArrowMatchWriter) writeMessage(b *fbBuilder, body []byte) error {
+	meta := b.buf[b.head:]
+	padded := (len(meta) + 8 + arrowBufferAlign - 1) &^ (arrowBufferAlign - 1)
+	var prefix [8]byte
+	binary.LittleEndian.PutUint32(prefix[0:], arrowContinuation)
+	binary.LittleEndian.PutUint32(prefix[4:], uint32(padded-8))
+	a.w.Write(prefix[:])
+	a.w.Write(meta)
+	a.w.Write(make([]byte, padded-8-len(meta)))
+	_, err := a.w.Write(body)
+	return err
+}
+
+// message wraps a built header table into a Message root
+func message(b *fbBuilder, headerType uint8, header int, bodyLength int) *fbBuilder {
+	b.startTable(5)
+	b.addUint64(3, uint64(bodyLength)) // bodyLength
+	b.addOffset(2, header)             // header
+	b.addUint16(0, arrowMetadataV5)    // version
+	b.addUint8(1, headerType)          // header_type
+	b.finish(b.endTable())
+	return b
+}
+
+func (a *ArrowMatchWriter) schema(documents, patterns []string) *fbBuilder {
+	b := newFBBuilder()
+	type column struct {
+		name     string
+		bits     uint32 // 0 = utf8
+		nullable bool
+	}
+	columns := [arrowColumnCount]column{
+		{"doc_id", 32, false}, {"offset", 64, false}, {"length", 32, false},
+		{"pattern_id", 32, false}, {"confidence", 8, false}, {"speaker", 0, true},
+	}
+
+	fields := make([]int, len(columns))
+	for i, c := range columns {
+		name := b.createString(c.name)
+		typeType := uint8(arrowTypeUtf8)
+		b.startTable(2)
+		if c.bits != 0 {
+			typeType = arrowTypeInt
+			b.addUint32(0, c.bits) // Int.bitWidth; is_signed defaults to false
+		}
+		typ := b.endTable()
+		children := b.offsetVector(nil)
+
+		b.startTable(7)
+		b.addOffset(0, name)
+		b.addOffset(3, typ)
+		b.addOffset(5, children)
+		b.addUint8(2, typeType)
+		if c.nullable {
+			b.addUint8(1, 1)
+		}
+		fields[i] = b.endTable()
+	}
+	fieldVector := b.offsetVector(fields)
+
+	var metadata []int
+	for _, kv := range [][2]string{
+		{"documents", strings.Join(documents, "\n")},
+		{"patterns", strings.Join(patterns, "\n")},
+	} {
+		key, value := b.createString(kv[0]), b.createString(kv[1])
+		b.startTable(2)
+		b.addOffset(0, key)
+		b.addOffset(1, value)
+		metadata = append(metadata, b.endTable())
+	}
+	metadataVector := b.offsetVector(metadata)
+
+	b.startTable(4)
+	b.addOffset(1, fieldVector)
+	b.addOffset(2, metadataVector) // endianness defaults to Little
+	return message(b, arrowHeaderSchema, b.endTable(), 0)
+}
+
+func (a *ArrowMatchWriter) recordBatch() *fbBuilder {
+	b := newFBBuilder()
+
+	// Vectors of structs: FieldNode{length, null_count}, Buffer{offset, length}
+	b.startVector(16, arrowColumnCount, 8)
+	for i := arrowColumnCount - 1; i >= 0; i-- {
+		nulls := 0
+		if i == arrowSpeakerColumn {
+			nulls = a.speakerNulls
+		}
+		b.putUint64(uint64(nulls))
+		b.putUint64(uint64(a.rows))
+	}
+	nodes := b.endVector(arrowColumnCount)
+
+	b.startVector(16, len(a.buffers), 8)
+	for i := len(a.buffers) - 1; i >= 0; i-- {
+		b.putUint64(uint64(a.buffers[i].length))
+		b.putUint64(uint64(a.buffers[i].offset))
+	}
+	buffers := b.endVector(len(a.buffers))
+
+	b.startTable(5)
+	b.addUint64(0, uint64(a.rows))
+	b.addOffset(1, nodes)
+	b.addOffset(2, buffers)
+	return message(b, arrowHeaderBatch, b.endTable(), len(a.body))
+}
+
+// runArrowExport matches every document of an archive and writes the
+// matches as an Arrow IPC stream
+func runArrowExport(root, outPath, patternPath string) error {
+	patterns := LegalPatterns
+	if patternPath != "" {
+		var err error
+		if patterns, err = readPatternFile(patternPath); err != nil {
+			return err
+		}
+	}
+	files, err := listArchive(root)
+	if err != nil {
+		return err
+	}
+	documents := make([]string, len(files))
+	for i, f := range files {
+		documents[i] = f.Path
+	}
+
+	out, err := os.Create(outPath)
+	if err != nil {
+		return err
+	}
+	defer out.Close()
+	writer, err := NewArrowMatchWriter(out, documents, patterns)
+	if err != nil {
+		return err
+	}
+
+	start := time.Now()
+	matcher := NewPureMatcherWithPatterns(patterns)
+	speakers := []string{unattributed}
+	speakerIDs := map[string]uint32{unattributed: 0}
+	for id, file := range files {
+		data, err := os.ReadFile(filepath.Join(root, filepath.FromSlash(file.Path)))
+		if err != nil {
+			return err
+		}
+		text := string(data)
+		turns := speakerTurns(text, speakerIDs, &speakers)
+		for _, r := range matcher.SearchUncached(text) {
+			speaker := ""
+			if s := speakerAt(turns, int(r.Offset)); s != 0 {
+				speaker = speakers[s]
+			}
+			if err := writer.Append(uint32(id), r, speaker); err != nil {
+				return err
+			}
+		}
+	}
+	if err := writer.Close(); err != nil {
+		return err
+	}
+	if err := out.Close(); err != nil {
+		return err
+	}
+
+	fmt.Printf("📦 Wrote %d matches from %d documents in %d record batches to %s (%v)\n",
+		writer.matches, len(files), writer.batches, outPath, time.Since(start))
+	return nil
+}
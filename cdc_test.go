@@ -0,0 +1,147 @@
+package main
+
+import (
+	"math/rand"
+	"sort"
+	"strings"
+	"testing"
+)
+
+// sortedSearch is the reference: SearchUncached in Scan's order
+func sortedSearch(m *PureMatcher, text string) []MatchResult {
+	results := m.SearchUncached(text)
+	sort.Slice(results, func(i, j int) bool {
+		if results[i].Offset != results[j].Offset {
+			return results[i].Offset < results[j].Offset
+		}
+		return results[i].PatternID < results[j].PatternID
+	})
+	return results
+}
+
+// checkScan compares Scan with a full search and returns how many matches
+// cross one cut and how many cross several
+func checkScan(t *testing.T, c *ChunkedMatcher, text string) (straddling, multiCut int) {
+	t.Helper()
+	got, _ := c.Scan(text)
+	want := sortedSearch(c.matcher, text)
+	if len(got) != len(want) {
+		t.Fatalf("Scan found %d matches, SearchUncached %d", len(got), len(want))
+	}
+	for i := range got {
+		if got[i] != want[i] {
+			t.Fatalf("match %d = %+v, want %+v", i, got[i], want[i])
+		}
+	}
+
+	bounds := ChunkBoundaries([]byte(text))
+	for _, r := range want {
+		start, end := int(r.Offset), int(r.Offset+r.Length)
+		cuts := sort.SearchInts(bounds, end) - sort.SearchInts(bounds, start+1)
+		if cuts > 0 {
+			straddling++
+		}
+		if cuts > 1 {
+			multiCut++
+		}
+	}
+	return straddling, multiCut
+}
+
+func randomTranscript(rng *rand.Rand, size int) string {
+	words := []string{"the", "witness", "He", "SAID", "said", "told", "me", "she", "Reportedly",
+		"allegedly", "according", "to", "Émile", "déjà", "vu", "İstanbul", "court", "\n", "Q:", "A:"}
+	var b strings.Builder
+	for b.Len() < size {
+		b.WriteString(words[rng.Intn(len(words))])
+		b.WriteByte(' ')
+	}
+	return b.String()
+}
+
+// Edited revisions share most chunks with the original; every revision
+// must still match exactly like a full scan
+func TestChunkedScanMatchesSearchOnRevisions(t *testing.T) {
+	rng := rand.New(rand.NewSource(7))
+	c := NewChunkedMatcher(NewPureMatcher(), NewChunkMemo(1<<12))
+	text := randomTranscript(rng, 400<<10)
+
+	straddling := 0
+	for rev := 0; rev < 25; rev++ {
+		n, _ := checkScan(t, c, text)
+		straddling += n
+
+		at := rng.Intn(len(text))
+		switch rev % 3 {
+		case 0: // Insert
+			text = text[:at] + randomTranscript(rng, rng.Intn(3000)) + text[at:]
+		case 1: // Delete
+			end := min(at+rng.Intn(5000), len(text))
+			text = text[:at] + text[end:]
+		case 2: // Replace, possibly splitting a multi-byte rune
+			end := min(at+rng.Intn(200), len(text))
+			text = text[:at] + "HE SAID, she told me" + text[end:]
+		}
+	}
+	if straddling == 0 {
+		t.Fatal("no match crossed a chunk cut; the test does not cover cut windows")
+	}
+	if stats := c.memo.GetStats(); stats.Hits == 0 {
+		t.Fatal("no chunk was answered from the memo")
+	}
+}
+
+// The longest pattern placed at every distance before a cut exercises the
+// edges of the boundary windows
+func TestChunkedScanWindowEdges(t *testing.T) {
+	rng := rand.New(rand.NewSource(3))
+	m := NewPureMatcher()
+	c := NewChunkedMatcher(m, NewChunkMemo(1<<12))
+	longest := ""
+	for _, p := range LegalPatterns {
+		if len(p) > len(longest) {
+			longest = p
+		}
+	}
+
+	// Cuts inside a run of one byte fall at cdcMaxSize, so writing the
+	// pattern over one rarely moves it
+	base := randomTranscript(rng, 32<<10) + strings.Repeat("x", 3*cdcMaxSize)
+	bounds := ChunkBoundaries([]byte(base))
+	covered := make(map[int]bool)
+	for _, cut := range bounds[1 : len(bounds)-1] {
+		for k := 1; k < len(longest); k++ {
+			text := base[:cut-k] + strings.ToUpper(longest) + base[cut-k+len(longest):]
+			checkScan(t, c, text)
+			b := ChunkBoundaries([]byte(text))
+			if i := sort.SearchInts(b, cut-k+1); i < len(b) && b[i] < cut-k+len(longest) {
+				covered[b[i]-(cut-k)] = true
+			}
+		}
+	}
+	for k := 1; k < len(longest); k++ {
+		if !covered[k] {
+			t.Fatalf("no cut fell %d bytes into %q", k, longest)
+		}
+	}
+}
+
+// A pattern longer than the minimum chunk spans whole chunks; it must be
+// reported once, credited to the first cut it crosses
+func TestChunkedScanPatternsLongerThanChunks(t *testing.T) {
+	rng := rand.New(rand.NewSource(11))
+	long := randomTranscript(rng, 5*cdcMaxSize/2)
+	m := NewPureMatcherWithPatterns(append([]string{long}, LegalPatterns...))
+	c := NewChunkedMatcher(m, NewChunkMemo(1<<12))
+
+	text := randomTranscript(rng, 50<<10) + long + randomTranscript(rng, 30<<10) +
+		strings.ToUpper(long) + long + randomTranscript(rng, 10<<10)
+	_, multiCut := checkScan(t, c, text)
+	if multiCut == 0 {
+		t.Fatal("no match crossed several cuts; the test does not cover short chunks")
+	}
+
+	// Rescanned with a warm memo after an edit before the long matches
+	text = "HE SAID " + text
+	checkScan(t, c, text)
+}
@@ -0,0 +1,302 @@
+package main
+
+import (
+	"encoding/binary"
+	"fmt"
+	"hash/fnv"
+	"os"
+	"path/filepath"
+	"sort"
+	"time"
+)
+
+// Near-duplicate routing for bulk ingest. Every document gets a MinHash
+// signature; banded LSH finds earlier documents likely to share most of
+// its shingles, and the route decides how much matching it needs:
+//
+//	duplicate  identical bytes: the earlier results are reused as is
+//	near       estimated Jaccard >= nearDupThreshold: delta scan through
+//	           the chunk memo, which already holds the original's chunks
+//	unique     full scan, whose results also seed the chunk memo
+//
+// Signatures use one-permutation hashing: each 8-byte shingle is hashed
+// once and lands in one of minhashSize bins (keeping the minimum), with
+// empty bins densified from their right neighbour. That is one hash per
+// byte instead of one per byte per permutation.
+
+const (
+	minhashSize      = 128
+	minhashShingle   = 8
+	lshBands         = 16 // x lshRows = minhashSize; ~0.7 Jaccard detection threshold
+	lshRows          = minhashSize / lshBands
+	nearDupThreshold = 0.8
+)
+
+// MinHashSignature is a document sketch; the share of equal slots
+// estimates the Jaccard similarity of the shingle sets
+type MinHashSignature [minhashSize]uint32
+
+func mix64(x uint64) uint64 {
+	x = (x ^ x>>30) * 0xbf58476d1ce4e5b9
+	x = (x ^ x>>27) * 0x94d049bb133111eb
+	return x ^ x>>31
+}
+
+// ComputeMinHash sketches the case-folded 8-byte shingles of data
+func ComputeMinHash(data []byte) MinHashSignature {
+	var sig MinHashSignature
+	var filled [minhashSize]bool
+	for i := range sig {
+		sig[i] = ^uint32(0)
+	}
+
+	add := func(shingle uint64) {
+		h := mix64(shingle)
+		bin := h >> (64 - 7) // log2(minhashSize) top bits pick the bin
+		if v := uint32(h); v < sig[bin] || !filled[bin] {
+			sig[bin] = v
+			filled[bin] = true
+		}
+	}
+	var shingle uint64
+	for i, c := range data {
+		shingle = shingle<<8 | uint64(foldASCII(c))
+		if i+1 >= minhashShingle {
+			add(shingle)
+		}
+	}
+	if len(data) > 0 && len(data) < minhashShingle {
+		add(shingle)
+	}
+
+	// Densify: an empty bin borrows the next filled bin's value, salted by
+	// the distance so borrowed slots only agree when the layout does
+	for i := range sig {
+		if filled[i] {
+			continue
+		}
+		for d := 1; d < minhashSize; d++ {
+			if j := (i + d) % minhashSize; filled[j] {
+				sig[i] = sig[j] + uint32(d)*0x9e3779b9
+				break
+			}
+		}
+	}
+	return sig
+}
+
+// Similarity estimates the Jaccard similarity of two documents
+func (s *MinHashSignature) Similarity(other *MinHashSignature) float64 {
+	equal := 0
+	for i := range s {
+		if s[i] == other[i] {
+			equal++
+		}
+	}
+	return float64(equal) / minhashSize
+}
+
+func (s *MinHashSignature) bandKey(band int) uint64 {
+	h := fnv.New64a()
+	var buf [4 + 4*lshRows]byte
+	binary.LittleEndian.PutUint32(buf[:], uint32(band))
+	for r := 0; r < lshRows; r++ {
+		binary.LittleEndian.PutUint32(buf[4+4*r:], s[band*lshRows+r])
+	}
+	h.Write(buf[:])
+	return h.Sum64()
+}
+
+// IngestRoute is how a document was matched
+type IngestRoute int
+
+const (
+	RouteUnique IngestRoute = iota
+	RouteNearDuplicate
+	RouteDuplicate
+)
+
+func (r IngestRoute) String() string {
+	switch r {
+	case RouteNearDuplicate:
+		return "near-duplicate"
+	case RouteDuplicate:
+		return "duplicate"
+	}
+	return "unique"
+}
+
+// IngestResult reports one ingested document
+type IngestResult struct {
+	Matches      []MatchResult
+	Route        IngestRoute
+	Original     string  // Closest earlier document (near/duplicate routes)
+	Similarity   float64 // Estimated Jaccard with Original
+	ScannedBytes int64
+}
+
+// storedMatch is a match kept for later exact duplicates. It holds no
+// text, so it does not pin the document.
+type storedMatch struct {
+	Offset     uint64
+	Length     uint32
+	PatternID  uint32
+	Confidence uint32
+}
+
+type ingestedDoc struct {
+	name      string
+	signature MinHashSignature
+	key       chunkKey
+	matches   []storedMatch // Only on the first document with its key
+}
+
+// DedupIngester routes documents by near-duplicate detection. Not safe for
+// concurrent use.
+type DedupIngester struct {
+	chunked *ChunkedMatcher
+	docs    []ingestedDoc
+	bands   [lshBands]map[uint64][]int32
+	exact   map[chunkKey]int32
+}
+
+// NewDedupIngester creates an ingester matching with matcher
+func NewDedupIngester(matcher *PureMatcher, memo *ChunkMemo) *DedupIngester {
+	d := &DedupIngester{chunked: NewChunkedMatcher(matcher, memo), exact: make(map[chunkKey]int32)}
+	for i := range d.bands {
+		d.bands[i] = make(map[uint64][]int32)
+	}
+	return d
+}
+
+// closest returns the most similar earlier document sharing a band
+func (d *DedupIngester) closest(sig *MinHashSignature) (int32, float64) {
+	best, bestSim := int32(-1), 0.0
+	seen := make(map[int32]bool)
+	for b := range d.bands {
+		for _, id := range d.bands[b][sig.bandKey(b)] {
+			if seen[id] {
+				continue
+			}
+			seen[id] = true
+			if sim := sig.Similarity(&d.docs[id].signature); sim > bestSim {
+				best, bestSim = id, sim
+			}
+		}
+	}
+	return best, bestSim
+}
+
+// Ingest matches one document, reusing earlier work where it can
+func (d *DedupIngester) Ingest(name, text string) IngestResult {
+	data := []byte(text)
+	key := makeChunkKey(data)
+	sig := ComputeMinHash(data)
+	var res IngestResult
+
+	if id, ok := d.exact[key]; ok {
+		orig := &d.docs[id]
+		res = IngestResult{Route: RouteDuplicate, Original: orig.name, Similarity: 1}
+		res.Matches = make([]MatchResult, len(orig.matches))
+		for i, m := range orig.matches {
+			end := m.Offset + uint64(m.Length)
+			res.Matches[i] = MatchResult{Offset: m.Offset, Length: uint64(m.Length), PatternID: m.PatternID,
+				Confidence: m.Confidence, Text: text[m.Offset:end]}
+		}
+	} else if id, sim := d.closest(&sig); id >= 0 && sim >= nearDupThreshold {
+		matches, stats := d.chunked.Scan(text)
+		res = IngestResult{Matches: matches, Route: RouteNearDuplicate, Original: d.docs[id].name,
+			Similarity: sim, ScannedBytes: stats.ScannedBytes}
+	} else {
+		res = IngestResult{Matches: d.fullScan(text, data), Route: RouteUnique, Similarity: sim,
+			ScannedBytes: int64(len(text))}
+		if id >= 0 {
+			res.Original = d.docs[id].name
+		}
+	}
+
+	id := int32(len(d.docs))
+	doc := ingestedDoc{name: name, signature: sig, key: key}
+	if _, ok := d.exact[key]; !ok {
+		d.exact[key] = id
+		doc.matches = make([]storedMatch, len(res.Matches))
+		for i, m := range res.Matches {
+			doc.matches[i] = storedMatch{Offset: m.Offset, Length: uint32(m.Length), PatternID: m.PatternID,
+				Confidence: m.Confidence}
+		}
+	}
+	d.docs = append(d.docs, doc)
+	for b := range d.bands {
+		k := sig.bandKey(b)
+		d.bands[b][k] = append(d.bands[b][k], id)
+	}
+	return res
+}
+
+// fullScan matches the whole text and seeds the chunk memo from the
+// result: matches inside a chunk belong to it, straddling ones are found
+// again by the boundary windows of a later delta scan
+func (d *DedupIngester) fullScan(text string, data []byte) []MatchResult {
+	results := d.chunked.matcher.SearchUncached(text)
+	sort.Slice(results, func(i, j int) bool {
+		if results[i].Offset != results[j].Offset {
+			return results[i].Offset < results[j].Offset
+		}
+		return results[i].PatternID < results[j].PatternID
+	})
+
+	bounds := ChunkBoundaries(data)
+	next := 0
+	for i := 0; i+1 < len(bounds); i++ {
+		start, end := uint64(bounds[i]), uint64(bounds[i+1])
+		for next < len(results) && results[next].Offset < start {
+			next++
+		}
+		var matches []chunkMatch
+		for k := next; k < len(results) && results[k].Offset < end; k++ {
+			if r := results[k]; r.Offset+r.Length <= end {
+				matches = append(matches, chunkMatch{Offset: uint32(r.Offset - start), Length: uint32(r.Length), PatternID: r.PatternID})
+			}
+		}
+		d.chunked.memo.put(makeChunkKey(data[start:end]), matches)
+	}
+	return results
+}
+
+// runIngest routes every file of an archive through the dedup ingester
+func runIngest(archive string) error {
+	files, err := listArchive(archive)
+	if err != nil {
+		return err
+	}
+	ingester := NewDedupIngester(NewPureMatcher(), NewChunkMemo(defaultChunkMemoSize))
+	start := time.Now()
+	var total, scanned int64
+	routes := make(map[IngestRoute]int)
+
+	for _, file := range files {
+		data, err := os.ReadFile(filepath.Join(archive, filepath.FromSlash(file.Path)))
+		if err != nil {
+			return err
+		}
+		res := ingester.Ingest(file.Path, string(data))
+		total += int64(len(data))
+		scanned += res.ScannedBytes
+		routes[res.Route]++
+		if res.Route == RouteUnique {
+			fmt.Printf("📄 %s: %d matches (unique)\n", file.Path, len(res.Matches))
+		} else {
+			fmt.Printf("📄 %s: %d matches (%s of %s, J≈%.2f, scanned %d bytes)\n",
+				file.Path, len(res.Matches), res.Route, res.Original, res.Similarity, res.ScannedBytes)
+		}
+	}
+
+	share := 0.0
+	if total > 0 {
+		share = 100 * float64(scanned) / float64(total)
+	}
+	fmt.Printf("\n📥 Ingested %d documents: %d unique, %d near-duplicates, %d duplicates\n",
+		len(files), routes[RouteUnique], routes[RouteNearDuplicate], routes[RouteDuplicate])
+	fmt.Printf("   Matched %d of %d bytes (%.1f%%, %v)\n", scanned, total, share, time.Since(start))
+	return nil
+}
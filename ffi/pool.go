@@ -0,0 +1,261 @@
+// Package ffi binds the C worker pool to Go. Matches come back through the
+// pool's per-worker SPSC result rings, which Go reads directly from shared
+// memory: draining costs no cgo call, no callback and no lock per match.
+package ffi
+
+/*
+#cgo CFLAGS: -I${SRCDIR}/.. -O3 -march=native
+#cgo LDFLAGS: -L${SRCDIR}/.. -Wl,-rpath,${SRCDIR}/.. -lmatcher -pthread
+#include <stdlib.h>
+#include <stddef.h>
+#include "worker_pool.h"
+
+// cgo does not expose flexible array members; publish the offset instead
+enum { ring_records_offset = offsetof(result_ring_t, records) };
+*/
+import "C"
+
+import (
+	"errors"
+	"runtime"
+	"sync/atomic"
+	"unsafe"
+)
+
+// DocEnd is the PatternID of the record closing each document
+const DocEnd = ^uint32(0)
+
+// DocError is the DocEnd Offset of a document the worker could not scan
+const DocError = ^uint64(0)
+
+// Match mirrors ring_match_t; Offset holds the match count (or DocError) on
+// DocEnd records
+type Match struct {
+	DocID     uint64
+	Offset    uint64
+	PatternID uint32
+	Length    uint32
+}
+
+// Engine mirrors matcher_engine_t
+type Engine int
+
+// Scan engines; EngineAuto never picks the JIT, which is opt-in
+const (
+	EngineAuto      Engine = C.MATCHER_ENGINE_AUTO
+	EngineSIMD      Engine = C.MATCHER_ENGINE_SIMD
+	EnginePrefilter Engine = C.MATCHER_ENGINE_PREFILTER
+	EngineRabinKarp Engine = C.MATCHER_ENGINE_RABIN_KARP
+	EngineWuManber  Engine = C.MATCHER_ENGINE_WU_MANBER
+	EngineJIT       Engine = C.MATCHER_ENGINE_JIT
+)
+
+// ErrQueueFull is returned when every in-flight slot or queue cell is taken
+var ErrQueueFull = errors.New("ffi: submission queue full")
+
+// PoolConfig selects worker placement and ring sizing
+type PoolConfig struct {
+	WorkersPerNode   uint32
+	CPUList          string // Affinity plan such as "2-5,8"; empty = NUMA layout
+	IsolatedCPUs     bool
+	BusyPoll         bool
+	ReplicatePerNode bool
+	RingCapacity     uint32   // Records per worker ring
+	MaxInFlight      int      // Documents submitted but not yet drained
+	MaxResults       int      // Match cap per document
+	Patterns         []string // Custom lexicon; empty = built-in legal patterns
+	Engine           Engine   // Requested engine; the zero value is EngineAuto
+}
+
+// docSlot tracks one in-flight document until its DocEnd record is drained
+type docSlot struct {
+	docID  uint64
+	pinner runtime.Pinner
+}
+
+// Pool is a C worker pool streaming matches into per-worker rings. Submit
+// may be called from one goroutine and Drain from another.
+type Pool struct {
+	state    *C.matcher_state_t
+	pool     *C.matcher_pool_t
+	jobs     []C.pool_job_t // C memory: workers hold these pointers
+	slots    []docSlot
+	free     chan int
+	rings    []*C.result_ring_t
+	maxMatch C.size_t
+}
+
+// NewPool initializes a matcher and starts its worker pool
+func NewPool(cfg PoolConfig) (*Pool, error) {
+	if cfg.RingCapacity == 0 {
+		cfg.RingCapacity = 1 << 16
+	}
+	if cfg.MaxInFlight <= 0 {
+		cfg.MaxInFlight = 1024
+	}
+	if cfg.MaxResults <= 0 {
+		cfg.MaxResults = 4096
+	}
+
+	state := (*C.matcher_state_t)(C.calloc(1, C.size_t(unsafe.Sizeof(C.matcher_state_t{}))))
+	state.engine = C.matcher_engine_t(cfg.Engine)
+	if len(cfg.Patterns) > 0 {
+		if initPatterns(state, cfg.Patterns) != 0 {
+			C.free(unsafe.Pointer(state))
+			return nil, errors.New("ffi: matcher_init_patterns failed")
+		}
+	} else if C.matcher_init(state) != 0 {
+		C.free(unsafe.Pointer(state))
+		return nil, errors.New("ffi: matcher_init failed")
+	}
+
+	var ccfg C.pool_config_t
+	C.pool_config_default(&ccfg)
+	ccfg.workers_per_node = C.uint32_t(cfg.WorkersPerNode)
+	ccfg.queue_capacity = C.uint32_t(cfg.MaxInFlight)
+	ccfg.replicate_per_node = C.bool(cfg.ReplicatePerNode)
+	ccfg.use_isolated_cpus = C.bool(cfg.IsolatedCPUs)
+	ccfg.busy_poll = C.bool(cfg.BusyPoll)
+	ccfg.result_ring_capacity = C.uint32_t(cfg.RingCapacity)
+	if cfg.CPUList != "" {
+		cpuList := C.CString(cfg.CPUList)
+		defer C.free(unsafe.Pointer(cpuList))
+		ccfg.cpu_list = cpuList // Only read during create
+	}
+
+	pool := C.matcher_pool_create(state, &ccfg)
+	if pool == nil {
+		C.matcher_cleanup(state)
+		C.free(unsafe.Pointer(state))
+		return nil, errors.New("ffi: matcher_pool_create failed")
+	}
+
+	p := &Pool{
+		state:    state,
+		pool:     pool,
+		slots:    make([]docSlot, cfg.MaxInFlight),
+		free:     make(chan int, cfg.MaxInFlight),
+		maxMatch: C.size_t(cfg.MaxResults),
+	}
+	jobBytes := C.size_t(cfg.MaxInFlight) * C.size_t(unsafe.Sizeof(C.pool_job_t{}))
+	p.jobs = unsafe.Slice((*C.pool_job_t)(C.calloc(1, jobBytes)), cfg.MaxInFlight)
+	for i := 0; i < cfg.MaxInFlight; i++ {
+		p.free <- i
+	}
+	for w := C.uint32_t(0); w < C.matcher_pool_worker_count(pool); w++ {
+		ring := C.matcher_pool_result_ring(pool, w)
+		if ring == nil {
+			p.Close()
+			return nil, errors.New("ffi: worker result ring unavailable")
+		}
+		p.rings = append(p.rings, ring)
+	}
+	return p, nil
+}
+
+// ActiveEngine names the engine the pool's matcher dispatches to
+func (p *Pool) ActiveEngine() string {
+	return C.GoString(C.matcher_engine_name(p.state.active_engine))
+}
+
+// initPatterns loads a custom lexicon; the table copies the strings
+func initPatterns(state *C.matcher_state_t, patterns []string) C.int {
+	texts := make([]*C.char, len(patterns))
+	for i, p := range patterns {
+		texts[i] = C.CString(p)
+		defer C.free(unsafe.Pointer(texts[i]))
+	}
+	return C.matcher_init_patterns(state, &texts[0], nil, C.size_t(len(texts)))
+}
+
+// Submit queues text for scanning without copying it. The text stays pinned
+// until the document's DocEnd record has been drained.
+func (p *Pool) Submit(docID uint64, text []byte) error {
+	var slot int
+	select {
+	case slot = <-p.free:
+	default:
+		return ErrQueueFull
+	}
+
+	s := &p.slots[slot]
+	s.docID = docID
+	job := &p.jobs[slot]
+	job.text = nil
+	if len(text) > 0 {
+		s.pinner.Pin(&text[0])
+		job.text = (*C.char)(unsafe.Pointer(&text[0]))
+	}
+	job.text_len = C.size_t(len(text))
+	job.results = nil // Stream into the worker's ring
+	job.max_results = p.maxMatch
+	job.doc_id = C.uint64_t(slot)
+
+	if C.matcher_pool_submit(p.pool, job) != 0 {
+		s.pinner.Unpin()
+		p.free <- slot
+		return ErrQueueFull
+	}
+	return nil
+}
+
+// Drain copies pending records from every ring into dst and returns how many
+// were written, how many documents completed and how many of those failed
+// (their DocEnd Offset is DocError). Only one goroutine may drain a pool at
+// a time.
+func (p *Pool) Drain(dst []Match) (n int, docsDone int, docsFailed int) {
+	for _, ring := range p.rings {
+		if n == len(dst) {
+			break
+		}
+		got := drainRing(ring, dst[n:])
+		for i := n; i < n+got; i++ {
+			slot := int(dst[i].DocID)
+			dst[i].DocID = p.slots[slot].docID
+			if dst[i].PatternID == DocEnd {
+				p.slots[slot].pinner.Unpin()
+				p.free <- slot
+				docsDone++
+				if dst[i].Offset == DocError {
+					docsFailed++
+				}
+			}
+		}
+		n += got
+	}
+	return n, docsDone, docsFailed
+}
+
+// drainRing is the Go side of result_ring_pop_bulk
+func drainRing(ring *C.result_ring_t, dst []Match) int {
+	head := uint64(ring.head) // Only the consumer writes head
+	tail := atomic.LoadUint64((*uint64)(unsafe.Pointer(&ring.tail)))
+	count := tail - head
+	if count > uint64(len(dst)) {
+		count = uint64(len(dst))
+	}
+	if count == 0 {
+		return 0
+	}
+
+	capacity := uint64(ring.capacity)
+	base := unsafe.Add(unsafe.Pointer(ring), C.ring_records_offset)
+	records := unsafe.Slice((*Match)(base), capacity)
+	start := head & uint64(ring.mask)
+	first := copy(dst[:count], records[start:])
+	copy(dst[first:count], records)
+
+	atomic.StoreUint64((*uint64)(unsafe.Pointer(&ring.head)), head+count)
+	return int(count)
+}
+
+// Close stops the workers; undrained documents are discarded
+func (p *Pool) Close() {
+	C.matcher_pool_destroy(p.pool)
+	for i := range p.slots {
+		p.slots[i].pinner.Unpin()
+	}
+	C.free(unsafe.Pointer(&p.jobs[0]))
+	C.matcher_cleanup(p.state)
+	C.free(unsafe.Pointer(p.state))
+}
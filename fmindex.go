@@ -0,0 +1,669 @@
+package main
+
+import (
+	"bufio"
+	"encoding/binary"
+	"errors"
+	"fmt"
+	"io"
+	"math"
+	"math/bits"
+	"os"
+	"path/filepath"
+	"sort"
+	"strconv"
+	"time"
+)
+
+// FM-index over a transcript archive for ad-hoc phrases. The case-folded
+// documents are joined with NUL separators (so no phrase spans two
+// documents), suffix sorted with SA-IS and reduced to their BWT, kept in a
+// wavelet matrix over the symbols actually present. count() is a backward
+// search, O(len(phrase) * log sigma) rank queries whatever the corpus size;
+// locate() walks LF from each hit to the nearest sampled suffix.
+//
+// Memory is ceil(log2 sigma) bits per byte for the BWT (7 for typical
+// transcripts) plus rank directories, one mark bit per byte and a 32-bit
+// sample every fmSampleRate positions: about 1.2x the text (1.1x when
+// sigma <= 64). The BWT is not entropy-coded, so this is larger than the
+// text, not the size of the compressed corpus.
+//
+// File layout (little endian): magic "LNPFMI01", u32 docCount, docs
+// { u16 pathLen, path, u64 start }, u64 n, u32 sampleRate, 256-byte symbol
+// map, u64 counts[sigma+1], u32 levels, per level { u64 zeros, bit
+// vector }, marks bit vector, u32 samples[]. A bit vector is u64 bitCount,
+// u64 words[], u64 superblock ranks[].
+
+const (
+	fmIndexMagic   = "LNPFMI01"
+	fmSampleRate   = 32
+	fmSeparator    = 0
+	rankSuperWords = 8 // 512-bit superblocks
+)
+
+// bitRank is a bit vector with rank support (one u64 count per 512 bits)
+type bitRank struct {
+	n     uint64
+	words []uint64
+	super []uint64
+}
+
+func newBitRank(n uint64) bitRank {
+	return bitRank{n: n, words: make([]uint64, (n+63)/64)}
+}
+
+func (b *bitRank) set(i uint64) {
+	b.words[i>>6] |= 1 << (i & 63)
+}
+
+func (b *bitRank) get(i uint64) bool {
+	return b.words[i>>6]&(1<<(i&63)) != 0
+}
+
+func (b *bitRank) buildRank() {
+	b.super = make([]uint64, len(b.words)/rankSuperWords+1)
+	var ones uint64
+	for w, word := range b.words {
+		if w%rankSuperWords == 0 {
+			b.super[w/rankSuperWords] = ones
+		}
+		ones += uint64(bits.OnesCount64(word))
+	}
+	// rank1(n) reads the entry past the last word when it starts a superblock
+	if len(b.words)%rankSuperWords == 0 {
+		b.super[len(b.words)/rankSuperWords] = ones
+	}
+}
+
+// rank1 counts set bits before position i
+func (b *bitRank) rank1(i uint64) uint64 {
+	w := i >> 6
+	r := b.super[w/rankSuperWords]
+	for k := w - w%rankSuperWords; k < w; k++ {
+		r += uint64(bits.OnesCount64(b.words[k]))
+	}
+	if i&63 != 0 {
+		r += uint64(bits.OnesCount64(b.words[w] & (1<<(i&63) - 1)))
+	}
+	return r
+}
+
+func (b *bitRank) rank0(i uint64) uint64 {
+	return i - b.rank1(i)
+}
+
+// waveletMatrix holds a sequence of small codes, one bit plane per level
+type waveletMatrix struct {
+	levels []bitRank
+	zeros  []uint64
+}
+
+func newWaveletMatrix(seq []uint8, sigma int) waveletMatrix {
+	depth := bits.Len(uint(sigma - 1))
+	if depth == 0 {
+		depth = 1
+	}
+	wm := waveletMatrix{levels: make([]bitRank, depth), zeros: make([]uint64, depth)}
+	cur := append([]uint8(nil), seq...)
+	next := make([]uint8, len(seq))
+	n := uint64(len(seq))
+	for l := 0; l < depth; l++ {
+		shift := uint(depth - 1 - l)
+		bv := newBitRank(n)
+		zeros := 0
+		for i, c := range cur {
+			if c>>shift&1 == 0 {
+				zeros++
+			} else {
+				bv.set(uint64(i))
+			}
+		}
+		// Stable partition: zeros first, then ones
+		z, o := 0, zeros
+		for _, c := range cur {
+			if c>>shift&1 == 0 {
+				next[z] = c
+				z++
+			} else {
+				next[o] = c
+				o++
+			}
+		}
+		bv.buildRank()
+		wm.levels[l] = bv
+		wm.zeros[l] = uint64(zeros)
+		cur, next = next, cur
+	}
+	return wm
+}
+
+// rank counts code c in seq[0:i)
+func (wm *waveletMatrix) rank(c uint8, i uint64) uint64 {
+	var start uint64
+	depth := len(wm.levels)
+	for l := 0; l < depth; l++ {
+		bv := &wm.levels[l]
+		if c>>uint(depth-1-l)&1 == 0 {
+			i, start = bv.rank0(i), bv.rank0(start)
+		} else {
+			i, start = wm.zeros[l]+bv.rank1(i), wm.zeros[l]+bv.rank1(start)
+		}
+	}
+	return i - start
+}
+
+func (wm *waveletMatrix) access(i uint64) uint8 {
+	var c uint8
+	for l := range wm.levels {
+		bv := &wm.levels[l]
+		if bv.get(i) {
+			c = c<<1 | 1
+			i = wm.zeros[l] + bv.rank1(i)
+		} else {
+			c <<= 1
+			i = bv.rank0(i)
+		}
+	}
+	return c
+}
+
+// sais computes the suffix array of s (symbols in [0, k)) as if followed by
+// a sentinel smaller than every symbol (Nong, Zhang & Chan's induced
+// sorting; recursion on the reduced LMS string)
+func sais(s []int32, sa []int32, k int) {
+	n := len(s)
+	switch n {
+	case 0:
+		return
+	case 1:
+		sa[0] = 0
+		return
+	}
+
+	// S-type: smaller than the next suffix. The last symbol is L-type
+	// (the sentinel follows it).
+	stype := make([]bool, n)
+	for i := n - 2; i >= 0; i-- {
+		stype[i] = s[i] < s[i+1] || (s[i] == s[i+1] && stype[i+1])
+	}
+	isLMS := func(i int) bool { return i > 0 && i < n && stype[i] && !stype[i-1] }
+
+	counts := make([]int32, k)
+	for _, c := range s {
+		counts[c]++
+	}
+	bkt := make([]int32, k)
+	bucketStarts := func() {
+		var sum int32
+		for c := range counts {
+			bkt[c] = sum
+			sum += counts[c]
+		}
+	}
+	bucketEnds := func() {
+		var sum int32
+		for c := range counts {
+			sum += counts[c]
+			bkt[c] = sum
+		}
+	}
+	induce := func() {
+		bucketStarts()
+		sa0 := n - 1 // Preceded the sentinel, the smallest suffix
+		sa[bkt[s[sa0]]] = int32(sa0)
+		bkt[s[sa0]]++
+		for i := 0; i < n; i++ {
+			if j := sa[i] - 1; sa[i] > 0 && !stype[j] {
+				sa[bkt[s[j]]] = j
+				bkt[s[j]]++
+			}
+		}
+		bucketEnds()
+		for i := n - 1; i >= 0; i-- {
+			if j := sa[i] - 1; sa[i] > 0 && stype[j] {
+				bkt[s[j]]--
+				sa[bkt[s[j]]] = j
+			}
+		}
+	}
+
+	// Sort LMS substrings: seed LMS positions at bucket ends and induce
+	for i := range sa {
+		sa[i] = -1
+	}
+	bucketEnds()
+	for i := n - 1; i > 0; i-- {
+		if isLMS(i) {
+			bkt[s[i]]--
+			sa[bkt[s[i]]] = int32(i)
+		}
+	}
+	induce()
+
+	// Compact the sorted LMS positions and name equal substrings
+	n1 := 0
+	for i := 0; i < n; i++ {
+		if isLMS(int(sa[i])) {
+			sa[n1] = sa[i]
+			n1++
+		}
+	}
+	names := sa[n1:]
+	for i := range names {
+		names[i] = -1
+	}
+	name := int32(0)
+	prev := -1
+	for i := 0; i < n1; i++ {
+		pos := int(sa[i])
+		diff := prev < 0
+		for d := 0; !diff; d++ {
+			if pos+d == n || prev+d == n || s[pos+d] != s[prev+d] || stype[pos+d] != stype[prev+d] {
+				diff = true
+			} else if d > 0 && isLMS(pos+d) {
+				break
+			}
+		}
+		if diff {
+			name++
+			prev = pos
+		}
+		names[pos/2] = name - 1 // LMS positions are never adjacent
+	}
+
+	s1 := make([]int32, 0, n1)
+	lms := make([]int32, 0, n1)
+	for i := 0; i < n; i++ {
+		if isLMS(i) {
+			s1 = append(s1, names[i/2])
+			lms = append(lms, int32(i))
+		}
+	}
+
+	// Order of the LMS suffixes: direct when the names are unique
+	sa1 := make([]int32, n1)
+	if int(name) < n1 {
+		sais(s1, sa1, int(name))
+	} else {
+		for i, c := range s1 {
+			sa1[c] = int32(i)
+		}
+	}
+
+	// Seed the sorted LMS suffixes at bucket ends and induce the rest
+	for i := range sa {
+		sa[i] = -1
+	}
+	bucketEnds()
+	for i := n1 - 1; i >= 0; i-- {
+		j := lms[sa1[i]]
+		bkt[s[j]]--
+		sa[bkt[s[j]]] = j
+	}
+	induce()
+}
+
+type fmDoc struct {
+	Path  string
+	Start uint64 // Text position of the document's first byte
+}
+
+// FMIndex answers phrase count/locate queries over an archive
+type FMIndex struct {
+	Docs    []fmDoc
+	n       uint64 // Text length including the sentinel row
+	rate    uint32
+	codes   [256]uint8 // Folded byte -> code (0: sentinel or absent)
+	counts  []uint64   // Rows with a smaller code, per code
+	bwt     waveletMatrix
+	marks   bitRank  // Rows whose suffix position is sampled
+	samples []uint32 // Sampled positions in row order
+}
+
+// BuildFMIndex indexes every file under root into indexPath
+func BuildFMIndex(root, indexPath string) (uint64, error) {
+	root, err := filepath.Abs(root)
+	if err != nil {
+		return 0, err
+	}
+	files, err := listArchive(root)
+	if err != nil {
+		return 0, err
+	}
+
+	var text []byte
+	docs := make([]fmDoc, 0, len(files))
+	for _, file := range files {
+		data, err := os.ReadFile(filepath.Join(root, filepath.FromSlash(file.Path)))
+		if err != nil {
+			return 0, err
+		}
+		docs = append(docs, fmDoc{Path: file.Path, Start: uint64(len(text))})
+		for _, c := range data {
+			text = append(text, foldASCII(c))
+		}
+		text = append(text, fmSeparator)
+		if len(text) >= math.MaxInt32 {
+			return 0, errors.New("fm index: archive over 2GB, index it in shards")
+		}
+	}
+
+	ix := buildFMIndex(text, docs)
+	if err := ix.write(indexPath); err != nil {
+		return 0, err
+	}
+	return uint64(len(text)), nil
+}
+
+func buildFMIndex(text []byte, docs []fmDoc) *FMIndex {
+	ix := &FMIndex{Docs: docs, n: uint64(len(text)) + 1, rate: fmSampleRate}
+
+	// Codes in byte order; 0 is the sentinel
+	sigma := 1
+	var present [256]bool
+	for _, c := range text {
+		present[c] = true
+	}
+	for c := 0; c < 256; c++ {
+		if present[c] {
+			ix.codes[c] = uint8(sigma)
+			sigma++
+		}
+	}
+
+	s := make([]int32, len(text))
+	for i, c := range text {
+		s[i] = int32(ix.codes[c])
+	}
+	sa := make([]int32, len(text))
+	sais(s, sa, sigma)
+
+	// Row 0 is the sentinel suffix (position n-1); row r > 0 is sa[r-1]
+	bwt := make([]uint8, ix.n)
+	ix.marks = newBitRank(ix.n)
+	ix.counts = make([]uint64, sigma+1)
+	row := func(r uint64) uint64 {
+		if r == 0 {
+			return ix.n - 1
+		}
+		return uint64(sa[r-1])
+	}
+	for r := uint64(0); r < ix.n; r++ {
+		pos := row(r)
+		if pos > 0 {
+			bwt[r] = uint8(s[pos-1])
+		}
+		ix.counts[bwt[r]+1]++
+		if pos%uint64(ix.rate) == 0 {
+			ix.marks.set(r)
+			ix.samples = append(ix.samples, uint32(pos))
+		}
+	}
+	for c := 1; c <= sigma; c++ {
+		ix.counts[c] += ix.counts[c-1]
+	}
+	ix.marks.buildRank()
+	ix.bwt = newWaveletMatrix(bwt, sigma)
+	return ix
+}
+
+// span returns the BWT rows [sp, ep) of suffixes starting with phrase
+func (ix *FMIndex) span(phrase string) (uint64, uint64) {
+	sp, ep := uint64(0), ix.n
+	for i := len(phrase) - 1; i >= 0 && sp < ep; i-- {
+		c := ix.codes[foldASCII(phrase[i])]
+		if c == 0 {
+			return 0, 0
+		}
+		sp = ix.counts[c] + ix.bwt.rank(c, sp)
+		ep = ix.counts[c] + ix.bwt.rank(c, ep)
+	}
+	return sp, ep
+}
+
+// Count returns the number of occurrences of phrase (ASCII case-insensitive)
+func (ix *FMIndex) Count(phrase string) uint64 {
+	if phrase == "" {
+		return 0
+	}
+	sp, ep := ix.span(phrase)
+	return ep - sp
+}
+
+// position walks LF to the nearest sampled row
+func (ix *FMIndex) position(r uint64) uint64 {
+	var steps uint64
+	for !ix.marks.get(r) {
+		c := ix.bwt.access(r)
+		r = ix.counts[c] + ix.bwt.rank(c, r)
+		steps++
+	}
+	return uint64(ix.samples[ix.marks.rank1(r)]) + steps
+}
+
+// PhraseHit is one located occurrence
+type PhraseHit struct {
+	Doc    string
+	Offset uint64
+}
+
+// Locate returns up to limit occurrences of phrase in archive order
+// (limit <= 0: all of them), plus the total count. Each location costs an
+// LF walk, so only limit rows are resolved: with a limit, the hits are an
+// arbitrary subset (the first rows in suffix order), not the earliest ones.
+func (ix *FMIndex) Locate(phrase string, limit int) ([]PhraseHit, uint64) {
+	if phrase == "" {
+		return nil, 0
+	}
+	sp, ep := ix.span(phrase)
+	total := ep - sp
+	if limit > 0 && ep-sp > uint64(limit) {
+		ep = sp + uint64(limit)
+	}
+	positions := make([]uint64, 0, ep-sp)
+	for r := sp; r < ep; r++ {
+		positions = append(positions, ix.position(r))
+	}
+	sort.Slice(positions, func(i, j int) bool { return positions[i] < positions[j] })
+
+	hits := make([]PhraseHit, len(positions))
+	for i, pos := range positions {
+		d := sort.Search(len(ix.Docs), func(k int) bool { return ix.Docs[k].Start > pos }) - 1
+		hits[i] = PhraseHit{Doc: ix.Docs[d].Path, Offset: pos - ix.Docs[d].Start}
+	}
+	return hits, total
+}
+
+func writeBitRank(w io.Writer, b *bitRank) error {
+	if err := binary.Write(w, binary.LittleEndian, b.n); err != nil {
+		return err
+	}
+	if err := binary.Write(w, binary.LittleEndian, b.words); err != nil {
+		return err
+	}
+	return binary.Write(w, binary.LittleEndian, b.super)
+}
+
+func readBitRank(r io.Reader) (bitRank, error) {
+	var b bitRank
+	if err := binary.Read(r, binary.LittleEndian, &b.n); err != nil {
+		return b, err
+	}
+	b.words = make([]uint64, (b.n+63)/64)
+	b.super = make([]uint64, len(b.words)/rankSuperWords+1)
+	if err := binary.Read(r, binary.LittleEndian, b.words); err != nil {
+		return b, err
+	}
+	return b, binary.Read(r, binary.LittleEndian, b.super)
+}
+
+func (ix *FMIndex) write(indexPath string) error {
+	tmp := indexPath + ".tmp"
+	f, err := os.Create(tmp)
+	if err != nil {
+		return err
+	}
+	w := bufio.NewWriterSize(f, 1<<20)
+	le := binary.LittleEndian
+
+	w.WriteString(fmIndexMagic)
+	binary.Write(w, le, uint32(len(ix.Docs)))
+	for _, d := range ix.Docs {
+		writeString16(w, d.Path)
+		binary.Write(w, le, d.Start)
+	}
+	binary.Write(w, le, ix.n)
+	binary.Write(w, le, ix.rate)
+	w.Write(ix.codes[:])
+	binary.Write(w, le, ix.counts)
+	binary.Write(w, le, uint32(len(ix.bwt.levels)))
+	for l := range ix.bwt.levels {
+		binary.Write(w, le, ix.bwt.zeros[l])
+		writeBitRank(w, &ix.bwt.levels[l])
+	}
+	writeBitRank(w, &ix.marks)
+	err = binary.Write(w, le, ix.samples)
+
+	if err == nil {
+		err = w.Flush()
+	}
+	if cerr := f.Close(); err == nil {
+		err = cerr
+	}
+	if err != nil {
+		os.Remove(tmp)
+		return err
+	}
+	return os.Rename(tmp, indexPath)
+}
+
+// OpenFMIndex loads an index written by BuildFMIndex
+func OpenFMIndex(indexPath string) (*FMIndex, error) {
+	f, err := os.Open(indexPath)
+	if err != nil {
+		return nil, err
+	}
+	defer f.Close()
+	ix, err := readFMIndex(bufio.NewReaderSize(f, 1<<20))
+	if err != nil {
+		return nil, fmt.Errorf("%s: %w", indexPath, err)
+	}
+	return ix, nil
+}
+
+func readFMIndex(r *bufio.Reader) (*FMIndex, error) {
+	le := binary.LittleEndian
+	magic := make([]byte, len(fmIndexMagic))
+	if _, err := io.ReadFull(r, magic); err != nil || string(magic) != fmIndexMagic {
+		return nil, errors.New("not an FM index")
+	}
+
+	ix := &FMIndex{}
+	var docCount uint32
+	if err := binary.Read(r, le, &docCount); err != nil {
+		return nil, err
+	}
+	for i := uint32(0); i < docCount; i++ {
+		path, err := readString16(r)
+		if err != nil {
+			return nil, err
+		}
+		d := fmDoc{Path: path}
+		if err := binary.Read(r, le, &d.Start); err != nil {
+			return nil, err
+		}
+		ix.Docs = append(ix.Docs, d)
+	}
+	if err := binary.Read(r, le, &ix.n); err != nil {
+		return nil, err
+	}
+	if err := binary.Read(r, le, &ix.rate); err != nil {
+		return nil, err
+	}
+	if _, err := io.ReadFull(r, ix.codes[:]); err != nil {
+		return nil, err
+	}
+	sigma := 1
+	for _, c := range ix.codes {
+		if c != 0 {
+			sigma++
+		}
+	}
+	ix.counts = make([]uint64, sigma+1)
+	if err := binary.Read(r, le, ix.counts); err != nil {
+		return nil, err
+	}
+
+	var depth uint32
+	if err := binary.Read(r, le, &depth); err != nil {
+		return nil, err
+	}
+	if depth > 8 {
+		return nil, errors.New("corrupt wavelet matrix")
+	}
+	ix.bwt = waveletMatrix{levels: make([]bitRank, depth), zeros: make([]uint64, depth)}
+	for l := range ix.bwt.levels {
+		if err := binary.Read(r, le, &ix.bwt.zeros[l]); err != nil {
+			return nil, err
+		}
+		var err error
+		if ix.bwt.levels[l], err = readBitRank(r); err != nil {
+			return nil, err
+		}
+	}
+	var err error
+	if ix.marks, err = readBitRank(r); err != nil {
+		return nil, err
+	}
+	ix.samples = make([]uint32, ix.marks.rank1(ix.marks.n))
+	if err := binary.Read(r, le, ix.samples); err != nil {
+		return nil, err
+	}
+	return ix, nil
+}
+
+// runFMIndex builds an FM index for the archive directory
+func runFMIndex(archive, indexPath string) error {
+	start := time.Now()
+	size, err := BuildFMIndex(archive, indexPath)
+	if err != nil {
+		return err
+	}
+	info, err := os.Stat(indexPath)
+	if err != nil {
+		return err
+	}
+	fmt.Printf("🗂️  FM index of %d bytes: %s, %d bytes (%.2fx, %v)\n",
+		size, indexPath, info.Size(), float64(info.Size())/float64(size), time.Since(start))
+	return nil
+}
+
+// runPhrase counts and locates an ad-hoc phrase
+func runPhrase(indexPath, phrase, limitArg string) error {
+	limit := 20
+	if limitArg != "" {
+		var err error
+		if limit, err = strconv.Atoi(limitArg); err != nil {
+			return fmt.Errorf("bad limit %q", limitArg)
+		}
+	}
+	for i := 0; i < len(phrase); i++ {
+		if phrase[i] == fmSeparator {
+			return errors.New("phrase contains a NUL byte")
+		}
+	}
+
+	ix, err := OpenFMIndex(indexPath)
+	if err != nil {
+		return err
+	}
+	start := time.Now()
+	hits, total := ix.Locate(phrase, limit)
+	elapsed := time.Since(start)
+
+	for _, h := range hits {
+		fmt.Printf("📍 %s:%d\n", h.Doc, h.Offset)
+	}
+	fmt.Printf("\n🔎 \"%s\": %d occurrences, %d shown (%v)\n", phrase, total, len(hits), elapsed)
+	return nil
+}
@@ -0,0 +1,99 @@
+package main
+
+import (
+	"bytes"
+	"math/rand"
+	"testing"
+)
+
+// naiveHits lists the offsets of phrase in text, ASCII case-insensitive
+func naiveHits(text []byte, phrase string) []uint64 {
+	var hits []uint64
+	p := []byte(phrase)
+	for i := range p {
+		p[i] = foldASCII(p[i])
+	}
+	for i := 0; i+len(p) <= len(text); i++ {
+		if bytes.Equal(text[i:i+len(p)], p) {
+			hits = append(hits, uint64(i))
+		}
+	}
+	return hits
+}
+
+func containsOffset(offsets []uint64, off uint64) bool {
+	for _, o := range offsets {
+		if o == off {
+			return true
+		}
+	}
+	return false
+}
+
+func TestFMIndexMatchesNaiveScan(t *testing.T) {
+	rng := rand.New(rand.NewSource(1))
+	words := []string{"he said ", "She Said ", "told me ", "the ", "witness ", "a", "b", "\n"}
+	phrases := []string{"he said", "she said", "told me", "the witness", "a", "ab", "ba", "e", "zz"}
+
+	// Lengths around every 64-bit word and 512-bit superblock boundary
+	// of the rank directories
+	for n := 1; n <= 1100; n++ {
+		var doc []byte
+		for len(doc) < n {
+			doc = append(doc, words[rng.Intn(len(words))]...)
+		}
+		doc = doc[:n]
+		folded := make([]byte, n)
+		for i, c := range doc {
+			folded[i] = foldASCII(c)
+		}
+		ix := buildFMIndex(append(folded, fmSeparator), []fmDoc{{Path: "doc", Start: 0}})
+
+		for _, phrase := range phrases {
+			want := naiveHits(folded, phrase)
+			if got := ix.Count(phrase); got != uint64(len(want)) {
+				t.Fatalf("len %d: Count(%q) = %d, want %d", n, phrase, got, len(want))
+			}
+			hits, total := ix.Locate(phrase, 0)
+			if total != uint64(len(want)) || len(hits) != len(want) {
+				t.Fatalf("len %d: Locate(%q) = %d hits of %d, want %d", n, phrase, len(hits), total, len(want))
+			}
+			for i, h := range hits {
+				if h.Doc != "doc" || h.Offset != want[i] {
+					t.Fatalf("len %d: Locate(%q)[%d] = %s:%d, want doc:%d", n, phrase, i, h.Doc, h.Offset, want[i])
+				}
+			}
+
+			// A limit resolves only that many rows, in archive order
+			hits, total = ix.Locate(phrase, 3)
+			if total != uint64(len(want)) || len(hits) != min(3, len(want)) {
+				t.Fatalf("len %d: Locate(%q, 3) = %d hits of %d, want %d", n, phrase, len(hits), total, len(want))
+			}
+			for i, h := range hits {
+				if i > 0 && h.Offset <= hits[i-1].Offset || !containsOffset(want, h.Offset) {
+					t.Fatalf("len %d: Locate(%q, 3) = %v, not a sorted subset of %v", n, phrase, hits, want)
+				}
+			}
+		}
+	}
+}
+
+func TestFMIndexDocumentBoundaries(t *testing.T) {
+	docs := []string{"He said no.", "and he", " said yes", "HE SAID"}
+	var text []byte
+	var index []fmDoc
+	for i, d := range docs {
+		index = append(index, fmDoc{Path: string(rune('a' + i)), Start: uint64(len(text))})
+		for _, c := range []byte(d) {
+			text = append(text, foldASCII(c))
+		}
+		text = append(text, fmSeparator)
+	}
+	ix := buildFMIndex(text, index)
+
+	// "he" + " said" across documents b and c must not match
+	hits, total := ix.Locate("he said", 0)
+	if total != 2 || len(hits) != 2 || hits[0] != (PhraseHit{"a", 0}) || hits[1] != (PhraseHit{"d", 0}) {
+		t.Fatalf("Locate = %v of %d, want a:0 and d:0", hits, total)
+	}
+}
@@ -0,0 +1,270 @@
+#include "jit.h"
+#include "roaring.h"
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+// x86-64 encodings used by the generated kernels (VEX.256, 0F map)
+#define PP_NONE      0
+#define PP_66        1
+#define PP_F3        2
+#define OP_MOVDQU    0x6F                   // F3: vmovdqu ymm, m256
+#define OP_PCMPEQB   0x74                   // 66
+#define OP_PMOVMSKB  0xD7                   // 66
+#define OP_PAND      0xDB                   // 66
+#define OP_POR       0xEB                   // 66
+#define OP_PXOR      0xEF                   // 66
+#define REG_RDI      7
+
+// Fixed kernel registers
+#define Y_ACC        0                      // Candidate accumulator
+#define Y_FIRST_FOLD 1                      // window[0..32) | 0x20
+#define Y_FIRST_RAW  2                      // window[0..32)
+#define Y_LAST_CMP   3
+#define Y_FIRST_CMP  4
+#define Y_LAST_RAW   5                      // window[len-1 ..), reloaded per length
+#define Y_LAST_FOLD  6
+#define Y_CASE       15                     // 32 x 0x20
+
+#define CASE_CONST   0                      // Page offset of the 0x20 vector
+
+typedef struct {
+    uint8_t* base;                          // Page start; size is a page offset
+    size_t size;
+    size_t capacity;
+    bool overflow;
+} jit_buffer_t;
+
+typedef struct {
+    uint32_t length;
+    uint8_t first;
+    uint8_t last;
+} jit_compare_t;
+
+static void emit_byte(jit_buffer_t* b, uint8_t byte) {
+    if (b->size < b->capacity) b->base[b->size] = byte;
+    else b->overflow = true;
+    b->size++;
+}
+
+static void emit_u32(jit_buffer_t* b, uint32_t value) {
+    for (int i = 0; i < 4; i++) emit_byte(b, (uint8_t)(value >> (8 * i)));
+}
+
+// Three-byte VEX: inverted R/X/B extension bits, map 0F, W0, L=256
+static void emit_vex(jit_buffer_t* b, unsigned pp, unsigned reg, unsigned vvvv, unsigned rm) {
+    emit_byte(b, 0xC4);
+    emit_byte(b, (uint8_t)((((reg >> 3) ^ 1) << 7) | (1 << 6) | (((rm >> 3) ^ 1) << 5) | 0x01));
+    emit_byte(b, (uint8_t)(((~vvvv & 0xF) << 3) | (1 << 2) | pp));
+}
+
+// op reg, vvvv, rm (all registers)
+static void emit_rr(jit_buffer_t* b, unsigned pp, uint8_t op, unsigned reg, unsigned vvvv, unsigned rm) {
+    emit_vex(b, pp, reg, vvvv, rm);
+    emit_byte(b, op);
+    emit_byte(b, (uint8_t)(0xC0 | (reg & 7) << 3 | (rm & 7)));
+}
+
+// op reg, vvvv, [rdi + disp]
+static void emit_rdi(jit_buffer_t* b, unsigned pp, uint8_t op, unsigned reg, unsigned vvvv, int32_t disp) {
+    emit_vex(b, pp, reg, vvvv, REG_RDI);
+    emit_byte(b, op);
+    if (disp >= -128 && disp <= 127) {
+        emit_byte(b, (uint8_t)(0x40 | (reg & 7) << 3 | REG_RDI));
+        emit_byte(b, (uint8_t)disp);
+    } else {
+        emit_byte(b, (uint8_t)(0x80 | (reg & 7) << 3 | REG_RDI));
+        emit_u32(b, (uint32_t)disp);
+    }
+}
+
+// op reg, vvvv, [rip + (target - next instruction)]; target is a page offset
+static void emit_rip(jit_buffer_t* b, unsigned pp, uint8_t op, unsigned reg, unsigned vvvv, size_t target) {
+    emit_vex(b, pp, reg, vvvv, 0);
+    emit_byte(b, op);
+    emit_byte(b, (uint8_t)((reg & 7) << 3 | 5));
+    emit_u32(b, (uint32_t)(int32_t)((int64_t)target - (int64_t)(b->size + 4)));
+}
+
+static bool is_folded_letter(uint8_t c) {
+    return (uint8_t)(c - 'a') < 26;
+}
+
+// Distinct (length, first, last) triples, ordered by length
+static uint32_t collect_compares(const pattern_table_t* table, jit_compare_t* compares) {
+    const uint16_t* lengths = pt_lengths(table);
+    const uint8_t* first = pt_first_bytes(table);
+    const uint8_t* last = pt_last_bytes(table);
+    uint32_t count = 0;
+
+    for (uint32_t i = 0; i < table->count; i++) {
+        jit_compare_t c = { lengths[i], first[i], last[i] };
+        bool seen = false;
+        for (uint32_t k = 0; k < count && !seen; k++) {
+            seen = compares[k].length == c.length && compares[k].first == c.first && compares[k].last == c.last;
+        }
+        if (seen) continue;
+
+        uint32_t at = count++;
+        while (at > 0 && compares[at - 1].length > c.length) {
+            compares[at] = compares[at - 1];
+            at--;
+        }
+        compares[at] = c;
+    }
+    return count;
+}
+
+static void emit_kernel(jit_buffer_t* b, const jit_compare_t* compares, uint32_t count) {
+    emit_rip(b, PP_F3, OP_MOVDQU, Y_CASE, 0, CASE_CONST);
+    emit_rdi(b, PP_F3, OP_MOVDQU, Y_FIRST_RAW, 0, 0);
+    emit_rr(b, PP_66, OP_POR, Y_FIRST_FOLD, Y_FIRST_RAW, Y_CASE);
+    emit_rr(b, PP_66, OP_PXOR, Y_ACC, Y_ACC, Y_ACC);
+
+    uint32_t loaded_length = 0;
+    bool last_folded = false;
+    for (uint32_t k = 0; k < count; k++) {
+        const jit_compare_t* c = &compares[k];
+        size_t first_const = 32 + (size_t)k * 64;
+        size_t last_const = first_const + 32;
+
+        if (c->length != loaded_length) {
+            emit_rdi(b, PP_F3, OP_MOVDQU, Y_LAST_RAW, 0, (int32_t)c->length - 1);
+            loaded_length = c->length;
+            last_folded = false;
+        }
+        unsigned last_src = Y_LAST_RAW;
+        if (is_folded_letter(c->last)) {
+            if (!last_folded) {
+                emit_rr(b, PP_66, OP_POR, Y_LAST_FOLD, Y_LAST_RAW, Y_CASE);
+                last_folded = true;
+            }
+            last_src = Y_LAST_FOLD;
+        }
+        unsigned first_src = is_folded_letter(c->first) ? Y_FIRST_FOLD : Y_FIRST_RAW;
+
+        emit_rip(b, PP_66, OP_PCMPEQB, Y_LAST_CMP, last_src, last_const);
+        emit_rip(b, PP_66, OP_PCMPEQB, Y_FIRST_CMP, first_src, first_const);
+        emit_rr(b, PP_66, OP_PAND, Y_FIRST_CMP, Y_FIRST_CMP, Y_LAST_CMP);
+        emit_rr(b, PP_66, OP_POR, Y_ACC, Y_ACC, Y_FIRST_CMP);
+    }
+
+    emit_rr(b, PP_66, OP_PMOVMSKB, 0, 0, Y_ACC);   // vpmovmskb eax, ymm0
+    emit_byte(b, 0xC5);                             // vzeroupper
+    emit_byte(b, 0xF8);
+    emit_byte(b, 0x77);
+    emit_byte(b, 0xC3);                             // ret
+}
+
+jit_kernel_t* jit_compile(const pattern_table_t* table) {
+    if (table->count == 0 || table->count > JIT_MAX_PATTERNS || table->max_len > JIT_MAX_LENGTH) {
+        return NULL;
+    }
+
+    jit_compare_t compares[JIT_MAX_PATTERNS];
+    uint32_t count = collect_compares(table, compares);
+
+    // Constants first (0x20 vector, then first/last vectors per compare)
+    size_t code_offset = 32 + (size_t)count * 64;
+    size_t code_budget = 64 + (size_t)count * 48;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t page_size = (code_offset + code_budget + page - 1) & ~(page - 1);
+
+    uint8_t* base = mmap(NULL, page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) return NULL;
+
+    memset(base + CASE_CONST, 0x20, 32);
+    for (uint32_t k = 0; k < count; k++) {
+        memset(base + 32 + (size_t)k * 64, compares[k].first, 32);
+        memset(base + 32 + (size_t)k * 64 + 32, compares[k].last, 32);
+    }
+
+    jit_buffer_t buffer = { base, code_offset, page_size, false };
+    emit_kernel(&buffer, compares, count);
+
+    // W^X: the page is never writable and executable at once
+    jit_kernel_t* jit = malloc(sizeof(*jit));
+    if (buffer.overflow || !jit || mprotect(base, page_size, PROT_READ | PROT_EXEC) != 0) {
+        free(jit);
+        munmap(base, page_size);
+        return NULL;
+    }
+
+    jit->page = base;
+    jit->page_size = page_size;
+    jit->code_size = buffer.size - code_offset;
+    jit->candidates = (jit_mask_fn)(void*)(base + code_offset);
+    jit->max_len = table->max_len;
+    jit->compare_count = count;
+    return jit;
+}
+
+void jit_free(jit_kernel_t* jit) {
+    if (!jit) return;
+    munmap(jit->page, jit->page_size);
+    free(jit);
+}
+
+// Verify candidate bits of the window at base against first-byte buckets
+static void verify_candidates(const pattern_table_t* table, bool whole_words, const uint8_t* text,
+                              size_t text_len, size_t base, uint32_t mask,
+                              match_result_t* results, size_t max_results, uint64_t* match_count) {
+    const uint32_t* buckets = pt_buckets(table);
+    const uint32_t* ids = pt_bucket_ids(table);
+    const uint16_t* lengths = pt_lengths(table);
+
+    while (mask && *match_count < max_results) {
+        size_t pos = base + (size_t)__builtin_ctz(mask);
+        mask &= mask - 1;
+        uint8_t first = fold_byte(text[pos]);
+
+        for (uint32_t k = buckets[first]; k < buckets[first + 1]; k++) {
+            uint32_t id = ids[k];
+            size_t length = lengths[id];
+            if (length > text_len - pos) continue;
+            if (!folded_equal(text + pos, pt_pattern(table, id), length)) continue;
+            if (whole_words && !word_bounded(text, text_len, pos, length)) continue;
+
+            match_result_t* match = &results[(*match_count)++];
+            match->offset = pos;
+            match->length = length;
+            match->pattern_id = id;
+            match->confidence = 95; // Fixed confidence for demo
+            if (*match_count >= max_results) break;
+        }
+    }
+}
+
+uint64_t jit_search(
+    const jit_kernel_t* jit,
+    const pattern_table_t* table,
+    bool whole_words,
+    const char* text,
+    size_t text_len,
+    match_result_t* results,
+    size_t max_results
+) {
+    const uint8_t* bytes = (const uint8_t*)text;
+    size_t window = JIT_BLOCK + jit->max_len - 1;   // Bytes one kernel call reads
+    uint64_t match_count = 0;
+    size_t p = 0;
+
+    for (; p + window <= text_len && match_count < max_results; p += JIT_BLOCK) {
+        uint32_t mask = jit->candidates(bytes + p);
+        if (mask) verify_candidates(table, whole_words, bytes, text_len, p, mask, results, max_results, &match_count);
+    }
+
+    // Tail: run the kernel over a zero-padded copy, keep in-text bits
+    uint8_t padded[JIT_BLOCK + JIT_MAX_LENGTH];
+    for (; p < text_len && match_count < max_results; p += JIT_BLOCK) {
+        size_t available = text_len - p < window ? text_len - p : window;
+        memset(padded, 0, sizeof(padded));
+        memcpy(padded, bytes + p, available);
+        uint32_t mask = jit->candidates(padded);
+        if (text_len - p < JIT_BLOCK) mask &= (1u << (text_len - p)) - 1;
+        if (mask) verify_candidates(table, whole_words, bytes, text_len, p, mask, results, max_results, &match_count);
+    }
+
+    return match_count;
+}
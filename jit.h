@@ -0,0 +1,56 @@
+#ifndef JIT_H
+#define JIT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "matcher.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define JIT_MAX_PATTERNS     64             // Larger sets belong to the table-driven engines
+#define JIT_MAX_LENGTH       128            // Keeps every load displacement in a disp8/disp32
+#define JIT_BLOCK            32             // Text positions per kernel call
+
+// Generated kernel: bit j of the result is set when position j of the
+// 32-byte window starts a candidate (first and last pattern bytes match).
+// Reads window[0 .. 32 + max_len - 1).
+typedef uint32_t (*jit_mask_fn)(const uint8_t* window);
+
+// Specialized AVX2 candidate kernel for one small pattern set, emitted
+// into its own page: constants first, then code, mapped read+execute once
+// written. Each pattern becomes a pair of VPCMPEQB against RIP-relative
+// broadcast constants (OR 0x20 folding only for letters), with last-byte
+// loads shared by patterns of equal length.
+typedef struct jit_kernel {
+    void* page;                     // mmap'd constants + code
+    size_t page_size;
+    size_t code_size;               // Bytes of emitted instructions
+    jit_mask_fn candidates;         // Entry point inside page
+    uint32_t max_len;               // Longest pattern (window overread)
+    uint32_t compare_count;         // Distinct (length, first, last) compares emitted
+} jit_kernel_t;
+
+// NULL when the set is too large/long or executable pages are refused
+jit_kernel_t* jit_compile(const pattern_table_t* table);
+void jit_free(jit_kernel_t* jit);
+
+// Scan with a compiled kernel; candidates are verified against the table
+// like the prefilter engine, so results are identical and in offset order
+uint64_t jit_search(
+    const jit_kernel_t* jit,
+    const pattern_table_t* table,
+    bool whole_words,
+    const char* text,
+    size_t text_len,
+    match_result_t* results,
+    size_t max_results
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // JIT_H
@@ -0,0 +1,417 @@
+package main
+
+import (
+	"bufio"
+	"bytes"
+	"errors"
+	"fmt"
+	"io"
+	"os"
+	"strconv"
+	"time"
+	"unicode/utf8"
+	"unsafe"
+)
+
+// JSON Lines mode: one record per input line, one result line per record.
+// Records are parsed in place (only a text field with escapes is decoded,
+// into a reused buffer) and results are appended to a reused output
+// buffer, so the steady state does not allocate per record and
+// throughput is bounded by the matcher. Input:
+//
+//	{"id": 17, "text": "He said ...", ...}     other fields are skipped
+//
+// Output, offsets in bytes of the decoded text:
+//
+//	{"id":17,"matches":[{"offset":0,"length":7,"pattern_id":0,"pattern":"he said","confidence":95}]}
+//
+// A record without an id gets its line number; a malformed one yields
+// {"line":N,"error":"..."} and the stream continues.
+
+const jsonlBufferSize = 1 << 20
+
+var (
+	errJSONLNotObject    = errors.New("record is not a JSON object")
+	errJSONLSyntax       = errors.New("malformed JSON")
+	errJSONLNoText       = errors.New("missing text field")
+	errJSONLTextType     = errors.New("text field is not a string")
+	errJSONLBadEscape    = errors.New("invalid string escape")
+	errJSONLUnterminated = errors.New("unterminated string")
+)
+
+// jsonCursor reads one record; it checks structure only as far as it
+// needs to find the fields
+type jsonCursor struct {
+	data []byte
+	pos  int
+}
+
+func (c *jsonCursor) skipSpace() {
+	for c.pos < len(c.data) {
+		switch c.data[c.pos] {
+		case ' ', '\t', '\r', '\n':
+			c.pos++
+		default:
+			return
+		}
+	}
+}
+
+func (c *jsonCursor) peek() byte {
+	if c.pos < len(c.data) {
+		return c.data[c.pos]
+	}
+	return 0
+}
+
+// str reads a string at the cursor and returns its raw contents
+func (c *jsonCursor) str() (raw []byte, escaped bool, err error) {
+	if c.peek() != '"' {
+		return nil, false, errJSONLSyntax
+	}
+	start := c.pos + 1
+	for i := start; i < len(c.data); i++ {
+		switch c.data[i] {
+		case '\\':
+			escaped = true
+			i++
+		case '"':
+			c.pos = i + 1
+			return c.data[start:i], escaped, nil
+		}
+	}
+	return nil, false, errJSONLUnterminated
+}
+
+// skipValue steps over any value: string, container or scalar
+func (c *jsonCursor) skipValue() error {
+	switch c.peek() {
+	case '"':
+		_, _, err := c.str()
+		return err
+	case '{', '[':
+		depth := 0
+		for c.pos < len(c.data) {
+			switch c.data[c.pos] {
+			case '"':
+				if _, _, err := c.str(); err != nil {
+					return err
+				}
+				continue
+			case '{', '[':
+				depth++
+			case '}', ']':
+				depth--
+			}
+			c.pos++
+			if depth == 0 {
+				return nil
+			}
+		}
+		return errJSONLSyntax
+	}
+	start := c.pos
+	for c.pos < len(c.data) {
+		switch c.data[c.pos] {
+		case ',', '}', ']', ' ', '\t', '\r', '\n':
+			if c.pos == start {
+				return errJSONLSyntax
+			}
+			return nil
+		}
+		c.pos++
+	}
+	return errJSONLSyntax
+}
+
+// unescapeJSON appends the decoded contents of a raw JSON string to dst
+func unescapeJSON(dst, raw []byte) ([]byte, error) {
+	for i := 0; i < len(raw); i++ {
+		c := raw[i]
+		if c != '\\' {
+			dst = append(dst, c)
+			continue
+		}
+		if i++; i >= len(raw) {
+			return dst, errJSONLBadEscape
+		}
+		switch raw[i] {
+		case '"', '\\', '/':
+			dst = append(dst, raw[i])
+		case 'b':
+			dst = append(dst, '\b')
+		case 'f':
+			dst = append(dst, '\f')
+		case 'n':
+			dst = append(dst, '\n')
+		case 'r':
+			dst = append(dst, '\r')
+		case 't':
+			dst = append(dst, '\t')
+		case 'u':
+			r, ok := hex4(raw[i+1:])
+			if !ok {
+				return dst, errJSONLBadEscape
+			}
+			i += 4
+			if r >= 0xD800 && r < 0xDC00 && i+6 < len(raw) && raw[i+1] == '\\' && raw[i+2] == 'u' {
+				if lo, ok := hex4(raw[i+3:]); ok && lo >= 0xDC00 && lo < 0xE000 {
+					r = 0x10000 + (r-0xD800)<<10 + (lo - 0xDC00)
+					i += 6
+				}
+			}
+			dst = utf8.AppendRune(dst, r) // Lone surrogates become U+FFFD
+		default:
+			return dst, errJSONLBadEscape
+		}
+	}
+	return dst, nil
+}
+
+func hex4(b []byte) (rune, bool) {
+	if len(b) < 4 {
+		return 0, false
+	}
+	var r rune
+	for _, c := range b[:4] {
+		switch {
+		case c >= '0' && c <= '9':
+			c -= '0'
+		case c|0x20 >= 'a' && c|0x20 <= 'f':
+			c = c | 0x20 - 'a' + 10
+		default:
+			return 0, false
+		}
+		r = r<<4 | rune(c)
+	}
+	return r, true
+}
+
+// parseJSONLRecord finds the id (raw JSON, nil if absent) and the text
+// field of one record. text aliases line unless it had escapes, in which
+// case it is decoded into buf, which is returned for reuse.
+func parseJSONLRecord(line []byte, field string, buf []byte) (id, text, outBuf []byte, err error) {
+	c := jsonCursor{data: line}
+	c.skipSpace()
+	if c.peek() != '{' {
+		return nil, nil, buf, errJSONLNotObject
+	}
+	c.pos++
+	found := false
+	for {
+		c.skipSpace()
+		if c.peek() == '}' {
+			break
+		}
+		key, _, err := c.str()
+		if err != nil {
+			return nil, nil, buf, err
+		}
+		c.skipSpace()
+		if c.peek() != ':' {
+			return nil, nil, buf, errJSONLSyntax
+		}
+		c.pos++
+		c.skipSpace()
+
+		switch {
+		case string(key) == field: // No allocation: compared in place
+			raw, escaped, err := c.str()
+			if err != nil {
+				if c.peek() != '"' {
+					return nil, nil, buf, errJSONLTextType
+				}
+				return nil, nil, buf, err
+			}
+			text, found = raw, true
+			if escaped {
+				if buf, err = unescapeJSON(buf[:0], raw); err != nil {
+					return nil, nil, buf, err
+				}
+				text = buf
+			}
+		case string(key) == "id":
+			start := c.pos
+			if err := c.skipValue(); err != nil {
+				return nil, nil, buf, err
+			}
+			id = line[start:c.pos]
+		default:
+			if err := c.skipValue(); err != nil {
+				return nil, nil, buf, err
+			}
+		}
+
+		c.skipSpace()
+		if c.peek() == ',' {
+			c.pos++
+			continue
+		}
+		if c.peek() != '}' {
+			return nil, nil, buf, errJSONLSyntax
+		}
+		break
+	}
+	if !found {
+		return nil, nil, buf, errJSONLNoText
+	}
+	return id, text, buf, nil
+}
+
+// appendJSONString appends s as a JSON string, escaping like encoding/json
+// (invalid UTF-8 becomes U+FFFD)
+func appendJSONString(dst []byte, s string) []byte {
+	const hex = "0123456789abcdef"
+	dst = append(dst, '"')
+	start := 0
+	for i := 0; i < len(s); {
+		c := s[i]
+		if c < utf8.RuneSelf {
+			if c >= 0x20 && c != '"' && c != '\\' {
+				i++
+				continue
+			}
+			dst = append(dst, s[start:i]...)
+			switch c {
+			case '"', '\\':
+				dst = append(dst, '\\', c)
+			case '\n':
+				dst = append(dst, '\\', 'n')
+			case '\r':
+				dst = append(dst, '\\', 'r')
+			case '\t':
+				dst = append(dst, '\\', 't')
+			default:
+				dst = append(dst, '\\', 'u', '0', '0', hex[c>>4], hex[c&0xF])
+			}
+			i++
+			start = i
+			continue
+		}
+		r, size := utf8.DecodeRuneInString(s[i:])
+		if r == utf8.RuneError && size == 1 {
+			dst = append(dst, s[start:i]...)
+			dst = append(dst, "\ufffd"...)
+			i += size
+			start = i
+			continue
+		}
+		if r == '\u2028' || r == '\u2029' {
+			dst = append(dst, s[start:i]...)
+			dst = append(dst, '\\', 'u', '2', '0', '2', hex[r&0xF])
+			i += size
+			start = i
+			continue
+		}
+		i += size
+	}
+	dst = append(dst, s[start:]...)
+	return append(dst, '"')
+}
+
+// appendJSONLResult encodes one result line
+func appendJSONLResult(dst, id []byte, line int, results []MatchResult, patterns []string) []byte {
+	dst = append(dst, `{"id":`...)
+	if id != nil {
+		dst = append(dst, id...)
+	} else {
+		dst = strconv.AppendInt(dst, int64(line), 10)
+	}
+	dst = append(dst, `,"matches":[`...)
+	for i, r := range results {
+		if i > 0 {
+			dst = append(dst, ',')
+		}
+		dst = append(dst, `{"offset":`...)
+		dst = strconv.AppendUint(dst, r.Offset, 10)
+		dst = append(dst, `,"length":`...)
+		dst = strconv.AppendUint(dst, r.Length, 10)
+		dst = append(dst, `,"pattern_id":`...)
+		dst = strconv.AppendUint(dst, uint64(r.PatternID), 10)
+		dst = append(dst, `,"pattern":`...)
+		dst = appendJSONString(dst, patterns[r.PatternID])
+		dst = append(dst, `,"confidence":`...)
+		dst = strconv.AppendUint(dst, uint64(r.Confidence), 10)
+		dst = append(dst, '}')
+	}
+	return append(dst, "]}\n"...)
+}
+
+func appendJSONLError(dst []byte, line int, err error) []byte {
+	dst = append(dst, `{"line":`...)
+	dst = strconv.AppendInt(dst, int64(line), 10)
+	dst = append(dst, `,"error":`...)
+	dst = appendJSONString(dst, err.Error())
+	return append(dst, "}\n"...)
+}
+
+// JSONLStats summarizes one JSONL run
+type JSONLStats struct {
+	Records, Errors, Matches int
+	Bytes                    int64
+}
+
+// ProcessJSONL matches the field of every record read from in and writes
+// one result line per record to out
+func ProcessJSONL(in io.Reader, out io.Writer, matcher *PureMatcher, field string) (JSONLStats, error) {
+	var stats JSONLStats
+	r := bufio.NewReaderSize(in, jsonlBufferSize)
+	w := bufio.NewWriterSize(out, jsonlBufferSize)
+	var long, unescaped, record []byte
+	var results []MatchResult
+
+	for lineNo := 1; ; lineNo++ {
+		line, err := r.ReadSlice('\n')
+		if err == bufio.ErrBufferFull {
+			// Longer than the read buffer: gather it in a reused buffer
+			long = append(long[:0], line...)
+			for err == bufio.ErrBufferFull {
+				line, err = r.ReadSlice('\n')
+				long = append(long, line...)
+			}
+			line = long
+		}
+		if err != nil && err != io.EOF {
+			return stats, err
+		}
+		stats.Bytes += int64(len(line))
+
+		if len(bytes.TrimSpace(line)) > 0 {
+			stats.Records++
+			var id, text []byte
+			var perr error
+			id, text, unescaped, perr = parseJSONLRecord(line, field, unescaped)
+			if perr != nil {
+				stats.Errors++
+				record = appendJSONLError(record[:0], lineNo, perr)
+			} else {
+				// The matcher only reads text while it runs and the encoder
+				// copies out what it keeps, so the bytes need no string copy
+				results = matcher.AppendMatches(results[:0], unsafe.String(unsafe.SliceData(text), len(text)))
+				stats.Matches += len(results)
+				record = appendJSONLResult(record[:0], id, lineNo, results, matcher.patterns)
+			}
+			if _, werr := w.Write(record); werr != nil {
+				return stats, werr
+			}
+		}
+		if err == io.EOF {
+			break
+		}
+	}
+	return stats, w.Flush()
+}
+
+// runJSONL filters stdin to stdout; the summary goes to stderr
+func runJSONL(field string) error {
+	start := time.Now()
+	stats, err := ProcessJSONL(os.Stdin, os.Stdout, NewPureMatcher(), field)
+	if err != nil {
+		return err
+	}
+	elapsed := time.Since(start)
+	fmt.Fprintf(os.Stderr, "📄 %d records (%d errors), %d matches, %.1f MB/s (%v)\n",
+		stats.Records, stats.Errors, stats.Matches,
+		float64(stats.Bytes)/(1<<20)/elapsed.Seconds(), elapsed)
+	return nil
+}
@@ -0,0 +1,235 @@
+package main
+
+import (
+	"bytes"
+	"encoding/json"
+	"io"
+	"strconv"
+	"strings"
+	"testing"
+)
+
+// decodeJSONString is the reference decoder for a raw string body
+func decodeJSONString(t *testing.T, raw string) string {
+	t.Helper()
+	var s string
+	if err := json.Unmarshal([]byte(`"`+raw+`"`), &s); err != nil {
+		t.Fatalf("reference decode of %q: %v", raw, err)
+	}
+	return s
+}
+
+func TestUnescapeJSONMatchesEncodingJSON(t *testing.T) {
+	for _, raw := range []string{
+		`plain`,
+		`\"\\\/\b\f\n\r\t`,
+		`he said \"hi\"`,
+		`éÉ中`,
+		`\ud83d\ude00`,         // Surrogate pair
+		`a\ud83db`,             // Lone high surrogate
+		`a\ude00b`,             // Lone low surrogate
+		`\ud83d\u0041`,         // High surrogate, then a non-surrogate escape
+		`\ud83d\ud83d\ude00`,   // High surrogate, then a full pair
+		`\ud83d`,               // High surrogate at the end
+		`\ude00\ud83d\ude00\n`, // Low, then a pair
+	} {
+		got, err := unescapeJSON(nil, []byte(raw))
+		if err != nil {
+			t.Errorf("%q: %v", raw, err)
+			continue
+		}
+		if want := decodeJSONString(t, raw); string(got) != want {
+			t.Errorf("%q: got %q, want %q", raw, got, want)
+		}
+	}
+
+	for _, raw := range []string{`\`, `\q`, `\u12`, `\u12g4`, `\x41`} {
+		if _, err := unescapeJSON(nil, []byte(raw)); err != errJSONLBadEscape {
+			t.Errorf("%q: err = %v, want %v", raw, err, errJSONLBadEscape)
+		}
+	}
+}
+
+func TestAppendJSONStringRoundTrips(t *testing.T) {
+	for _, s := range []string{
+		"",
+		"he said",
+		"quote \" backslash \\ slash /",
+		"\x00\x01\x1f\b\f\n\r\t\x7f",
+		"é中😀",
+		"line\u2028para\u2029end",
+		"bad \xff utf-8 \xc3",
+		"<html> & more",
+	} {
+		enc := appendJSONString(nil, s)
+		if !json.Valid(enc) {
+			t.Errorf("%q: invalid JSON %s", s, enc)
+			continue
+		}
+		var got string
+		if err := json.Unmarshal(enc, &got); err != nil {
+			t.Fatalf("%q: %v", s, err)
+		}
+		// Each invalid byte becomes one U+FFFD
+		if want := string([]rune(s)); got != want {
+			t.Errorf("%q: round trip gave %q, want %q", s, got, want)
+		}
+		if bytes.ContainsAny(enc, "\u2028\u2029") {
+			t.Errorf("%q: line separators left unescaped in %s", s, enc)
+		}
+	}
+}
+
+func TestParseJSONLRecord(t *testing.T) {
+	for _, tc := range []struct {
+		line, id, text string
+	}{
+		{`{"id": 17, "text": "He said"}`, `17`, "He said"},
+		{` { "text" : "x" } `, ``, "x"},
+		{`{"text":"a\nbé"}`, ``, "a\nbé"},
+		// Nested and skipped values, including a nested "text" and
+		// brackets and quotes inside strings
+		{`{"meta":{"text":"no","a":[1,{"b":"}]"}],"c":"\"{"},"tags":[],"n":-1.5e3,` +
+			`"ok":true,"nil":null,"id":"doc-\"7\"","text":"yes"}`, `"doc-\"7\""`, "yes"},
+		{`{"id":{"case":3},"text":"t","after":[[["deep"]]]}`, `{"case":3}`, "t"},
+	} {
+		id, text, _, err := parseJSONLRecord([]byte(tc.line), "text", nil)
+		if err != nil {
+			t.Errorf("%s: %v", tc.line, err)
+			continue
+		}
+		if string(id) != tc.id || string(text) != tc.text {
+			t.Errorf("%s: id %q text %q, want %q %q", tc.line, id, text, tc.id, tc.text)
+		}
+	}
+
+	for _, tc := range []struct {
+		line string
+		err  error
+	}{
+		{`[1, 2]`, errJSONLNotObject},
+		{`"text"`, errJSONLNotObject},
+		{`{"id": 1}`, errJSONLNoText},
+		{`{"meta": {"text": "nested only"}}`, errJSONLNoText},
+		{`{"text": 5}`, errJSONLTextType},
+		{`{"text": null}`, errJSONLTextType},
+		{`{"text": ["he said"]}`, errJSONLTextType},
+		{`{"text": "a\qb"}`, errJSONLBadEscape},
+		{`{"text": "open`, errJSONLUnterminated},
+		{`{"text": "a"`, errJSONLSyntax},
+		{`{"text" "a"}`, errJSONLSyntax},
+		{`{text: "a"}`, errJSONLSyntax},
+		{`{"id": [1, 2, "text": "a"}`, errJSONLSyntax},
+		{`{"text": "a" "id": 1}`, errJSONLSyntax},
+	} {
+		if _, _, _, err := parseJSONLRecord([]byte(tc.line), "text", nil); err != tc.err {
+			t.Errorf("%s: err = %v, want %v", tc.line, err, tc.err)
+		}
+	}
+}
+
+type jsonlOutput struct {
+	ID      json.RawMessage `json:"id"`
+	Line    int             `json:"line"`
+	Error   string          `json:"error"`
+	Matches []struct {
+		Offset     uint64 `json:"offset"`
+		Length     uint64 `json:"length"`
+		PatternID  uint32 `json:"pattern_id"`
+		Pattern    string `json:"pattern"`
+		Confidence uint32 `json:"confidence"`
+	} `json:"matches"`
+}
+
+func TestProcessJSONLMatchesSearch(t *testing.T) {
+	m := NewPureMatcher()
+	long := strings.Repeat("filler text, ", (jsonlBufferSize/13)+1000) + "He Said it"
+	texts := []string{
+		"he said the defendant was guilty",
+		"no triggers",
+		"she told me \"he said\"\nreportedly",
+		long,
+	}
+	var in bytes.Buffer
+	for i, text := range texts {
+		enc, _ := json.Marshal(map[string]any{"id": i * 10, "text": text, "extra": []int{1, 2}})
+		in.Write(enc)
+		in.WriteString("\n")
+		if i == 1 {
+			in.WriteString(`{"text": 42}` + "\n")
+			in.WriteString("not json\n\n")
+		}
+	}
+	in.WriteString(`{"text": "allegedly, without a newline"}`)
+
+	var out bytes.Buffer
+	stats, err := ProcessJSONL(&in, &out, m, "text")
+	if err != nil {
+		t.Fatal(err)
+	}
+	if stats.Records != 7 || stats.Errors != 2 {
+		t.Fatalf("stats %+v, want 7 records and 2 errors", stats)
+	}
+
+	lines := strings.Split(strings.TrimSuffix(out.String(), "\n"), "\n")
+	if len(lines) != 7 {
+		t.Fatalf("%d output lines, want 7", len(lines))
+	}
+	want := []struct {
+		id, errLine int
+		text        string
+	}{
+		{0, 0, texts[0]}, {10, 0, texts[1]}, {-1, 3, ""}, {-1, 4, ""},
+		{20, 0, texts[2]}, {30, 0, texts[3]}, {8, 0, "allegedly, without a newline"},
+	}
+	for i, line := range lines {
+		var got jsonlOutput
+		if err := json.Unmarshal([]byte(line), &got); err != nil {
+			t.Fatalf("line %d: %v: %s", i, err, line)
+		}
+		w := want[i]
+		if w.errLine > 0 {
+			if got.Line != w.errLine || got.Error == "" {
+				t.Errorf("line %d: %s, want an error for input line %d", i, line, w.errLine)
+			}
+			continue
+		}
+		if string(got.ID) != strconv.Itoa(w.id) {
+			t.Errorf("line %d: id %s, want %d", i, got.ID, w.id)
+		}
+		results := m.SearchUncached(w.text)
+		if len(got.Matches) != len(results) {
+			t.Fatalf("line %d: %d matches, want %d", i, len(got.Matches), len(results))
+		}
+		for k, r := range results {
+			g := got.Matches[k]
+			if g.Offset != r.Offset || g.Length != r.Length || g.PatternID != r.PatternID ||
+				g.Pattern != m.patterns[r.PatternID] || g.Confidence != r.Confidence {
+				t.Errorf("line %d match %d: %+v, want %+v", i, k, g, r)
+			}
+		}
+	}
+}
+
+// Buffers are reused across records, so a stream costs the same
+// allocations whatever its length
+func TestProcessJSONLAllocsPerRecord(t *testing.T) {
+	m := NewPureMatcher()
+	record := `{"id":1,"meta":{"a":[1,2]},"text":"He said \"she told me\" é reportedly"}` + "\n"
+	short := []byte(record)
+	many := bytes.Repeat(short, 1000)
+
+	var r bytes.Reader
+	run := func(input []byte) float64 {
+		return testing.AllocsPerRun(20, func() {
+			r.Reset(input)
+			if _, err := ProcessJSONL(&r, io.Discard, m, "text"); err != nil {
+				t.Fatal(err)
+			}
+		})
+	}
+	one, thousand := run(short), run(many)
+	if thousand != one {
+		t.Fatalf("1 record: %.0f allocs, 1000 records: %.0f allocs", one, thousand)
+	}
+}
@@ -3,7 +3,9 @@ package main
 import (
 	"bufio"
 	"fmt"
+	"io"
 	"os"
+	"strconv"
 	"strings"
 	"time"
 )
@@ -20,32 +22,28 @@ type MatchResult struct {
 // PureMatcher provides fast Go-based pattern matching
 type PureMatcher struct {
 	patterns []string
+	folded   []string // ASCII-folded patterns, as the C core folds them
 	cache    *Cache
 }
 
-// Legal hearsay patterns for demo
-var LegalPatterns = []string{
-	"he said",
-	"she said",
-	"she told",
-	"he told",
-	"i heard",
-	"according to",
-	"reportedly",
-	"allegedly",
-	"it was reported",
-	"sources say",
-	"witnesses claim",
-	"testimony indicates",
-	"didn't you say",
-	"you mentioned",
-	"as stated by",
-}
-
 // NewPureMatcher creates a pure Go matcher
 func NewPureMatcher() *PureMatcher {
+	return NewPureMatcherWithPatterns(LegalPatterns)
+}
+
+// NewPureMatcherWithPatterns creates a pure Go matcher for a custom lexicon
+func NewPureMatcherWithPatterns(patterns []string) *PureMatcher {
+	folded := make([]string, len(patterns))
+	for i, p := range patterns {
+		b := []byte(p)
+		for k := range b {
+			b[k] = foldASCII(b[k])
+		}
+		folded[i] = string(b)
+	}
 	return &PureMatcher{
-		patterns: LegalPatterns,
+		patterns: patterns,
+		folded:   folded,
 		cache:    NewCache(1000), // Cache up to 1000 results
 	}
 }
@@ -58,42 +56,89 @@ func (m *PureMatcher) Search(text string) ([]MatchResult, time.Duration, error)
 	}
 
 	start := time.Now()
-	var results []MatchResult
+	results := m.SearchUncached(text)
+	elapsed := time.Since(start)
 
-	// Convert to lowercase for case-insensitive matching
-	lowerText := strings.ToLower(text)
+	// Cache the results
+	m.cache.Put(text, results, elapsed)
 
-	// Search for each pattern
-	for patternID, pattern := range m.patterns {
-		lowerPattern := strings.ToLower(pattern)
+	return results, elapsed, nil
+}
 
-		// Find all occurrences of this pattern
-		offset := 0
-		for {
-			index := strings.Index(lowerText[offset:], lowerPattern)
-			if index == -1 {
-				break
-			}
+// SearchUncached matches without touching the cache (one-off documents
+// such as archive sweeps would only evict useful entries)
+func (m *PureMatcher) SearchUncached(text string) []MatchResult {
+	return m.AppendMatches(nil, text)
+}
+
+// indexByteFrom returns the first index >= from of c in s, or -1
+func indexByteFrom(s string, c byte, from int) int {
+	if j := strings.IndexByte(s[from:], c); j >= 0 {
+		return from + j
+	}
+	return -1
+}
+
+// appendFolded appends every start where text matches the folded pattern
+// under ASCII folding. Offsets stay those of text, which a Unicode
+// lower-casing would not preserve. The next position of each case of the
+// first byte is kept between candidates and only the case just consumed is
+// searched again, so the scan stays linear when one case is rare.
+func appendFolded(results []MatchResult, text, folded string, patternID int) []MatchResult {
+	last := len(text) - len(folded) // Last possible start
+	if len(folded) == 0 || last < 0 {
+		return results
+	}
+	starts := text[:last+1]
+	first := folded[0]
+	upper := first
+	if first-'a' < 26 {
+		upper = first - 0x20
+	}
+	nextFirst := indexByteFrom(starts, first, 0)
+	nextUpper := -1
+	if upper != first {
+		nextUpper = indexByteFrom(starts, upper, 0)
+	}
+
+	for {
+		i := nextFirst
+		if nextUpper >= 0 && (i < 0 || nextUpper < i) {
+			i = nextUpper
+		}
+		if i < 0 {
+			return results
+		}
+		if i == nextFirst {
+			nextFirst = indexByteFrom(starts, first, i+1)
+		} else {
+			nextUpper = indexByteFrom(starts, upper, i+1)
+		}
 
-			actualOffset := offset + index
+		k := 1
+		for k < len(folded) && foldASCII(text[i+k]) == folded[k] {
+			k++
+		}
+		if k == len(folded) {
 			results = append(results, MatchResult{
-				Offset:     uint64(actualOffset),
-				Length:     uint64(len(pattern)),
+				Offset:     uint64(i),
+				Length:     uint64(len(folded)),
 				PatternID:  uint32(patternID),
 				Confidence: 95, // Fixed confidence for demo
-				Text:       text[actualOffset : actualOffset+len(pattern)],
+				Text:       text[i : i+len(folded)],
 			})
-
-			offset = actualOffset + 1 // Move past this match
 		}
 	}
+}
 
-	elapsed := time.Since(start)
-
-	// Cache the results
-	m.cache.Put(text, results, elapsed)
-
-	return results, elapsed, nil
+// AppendMatches appends the matches in text to results, so streaming
+// callers can reuse one slice across documents. Matching is ASCII
+// case-insensitive and does not allocate.
+func (m *PureMatcher) AppendMatches(results []MatchResult, text string) []MatchResult {
+	for patternID, pattern := range m.folded {
+		results = appendFolded(results, text, pattern, patternID)
+	}
+	return results
 }
 
 // GetPatternName returns the pattern name for an ID
@@ -109,34 +154,43 @@ func (m *PureMatcher) GetCacheStats() CacheStats {
 	return m.cache.GetStats()
 }
 
-// formatResults formats search results for display
+// formatResults formats search results for display, building the whole
+// report in a pooled buffer so it costs one write instead of two per match
 func formatResults(text string, results []MatchResult, duration time.Duration, matcher *PureMatcher) {
+	bp := resultBufferPool.Get().(*[]byte)
+	b := (*bp)[:0]
 	if len(results) == 0 {
-		fmt.Printf("✅ No hearsay detected (%v)\n", duration)
-		return
+		b = append(b, "✅ No hearsay detected ("...)
+		b = append(b, duration.String()...)
+		b = append(b, ")\n"...)
+	} else {
+		b = append(b, "⚠️  HEARSAY DETECTED ("...)
+		b = strconv.AppendInt(b, int64(len(results)), 10)
+		b = append(b, " matches, "...)
+		b = append(b, duration.String()...)
+		b = append(b, "):\n"...)
 	}
-
-	fmt.Printf("⚠️  HEARSAY DETECTED (%d matches, %v):\n", len(results), duration)
 	for _, result := range results {
-		fmt.Printf("   • \"%s\" at position %d-%d (confidence: %d%%)\n",
-			result.Text, result.Offset, result.Offset+result.Length-1, result.Confidence)
+		b = append(b, "   • \""...)
+		b = append(b, result.Text...)
+		b = append(b, "\" at position "...)
+		b = strconv.AppendUint(b, result.Offset, 10)
+		b = append(b, '-')
+		b = strconv.AppendUint(b, result.Offset+result.Length-1, 10)
+		b = append(b, " (confidence: "...)
+		b = strconv.AppendUint(b, uint64(result.Confidence), 10)
+		b = append(b, "%)\n"...)
 
 		// Show context
-		start := int(result.Offset)
-		end := int(result.Offset + result.Length)
-		contextStart := start - 10
-		contextEnd := end + 10
-
-		if contextStart < 0 {
-			contextStart = 0
-		}
-		if contextEnd > len(text) {
-			contextEnd = len(text)
-		}
-
-		context := text[contextStart:contextEnd]
-		fmt.Printf("     Context: ...%s...\n", context)
+		contextStart := max(int(result.Offset)-10, 0)
+		contextEnd := min(int(result.Offset+result.Length)+10, len(text))
+		b = append(b, "     Context: ..."...)
+		b = append(b, text[contextStart:contextEnd]...)
+		b = append(b, "...\n"...)
 	}
+	os.Stdout.Write(b)
+	*bp = b[:0]
+	resultBufferPool.Put(bp)
 }
 
 // displayStats shows performance and cache statistics
@@ -205,24 +259,49 @@ func runBenchmark(matcher *PureMatcher) {
 	fmt.Printf("   Cache Hit Ratio: %.1f%%\n", matcher.cache.HitRatio())
 }
 
+// main exits with run's status so deferred profile flushes always happen
 func main() {
-	fmt.Println("🏛️  Legal NLP Pipeline - Ultra-Fast Hearsay Detection")
-	fmt.Println("⚡ Pure Go Implementation with Microsecond Response Times")
+	os.Exit(run())
+}
+
+// run executes the selected mode and returns the process exit status
+func run() int {
+	// Profiling flags may appear anywhere on the command line
+	profileCfg, args, err := parseProfileFlags(os.Args[1:])
+
+	// Streaming modes own stdout, so the banner goes to stderr there
+	banner := io.Writer(os.Stdout)
+	if len(args) > 0 && (args[0] == "--jsonl" || args[0] == "--dump") {
+		banner = os.Stderr
+	}
+	fmt.Fprintln(banner, "🏛️  Legal NLP Pipeline - Ultra-Fast Hearsay Detection")
+	fmt.Fprintln(banner, "⚡ Pure Go Implementation with Microsecond Response Times")
+
+	if err != nil {
+		fmt.Fprintf(os.Stderr, "❌ Error: %v\n", err)
+		return 2
+	}
+	stopProfiling, err := startProfiling(profileCfg)
+	if err != nil {
+		fmt.Fprintf(os.Stderr, "❌ Error: %v\n", err)
+		return 1
+	}
+	defer stopProfiling()
 
 	// Initialize matcher
 	matcher := NewPureMatcher()
-	fmt.Printf("📚 Loaded %d legal hearsay patterns\n", len(LegalPatterns))
+	fmt.Fprintf(banner, "📚 Loaded %d legal hearsay patterns\n", len(LegalPatterns))
 
 	// Performance tracking
 	var totalSearches, totalMatches int64
 	var totalTime time.Duration
 
 	// Check for command line arguments
-	if len(os.Args) > 1 {
-		switch os.Args[1] {
+	if len(args) > 0 {
+		switch args[0] {
 		case "--benchmark", "-b":
 			runBenchmark(matcher)
-			return
+			return 0
 		case "--test", "-t":
 			// Run test cases
 			testCases := []string{
@@ -247,14 +326,169 @@ func main() {
 			}
 
 			displayStats(matcher, totalSearches, totalMatches, totalTime)
-			return
+			return 0
+		case "--index":
+			if len(args) < 3 {
+				fmt.Println("❌ Usage: legal-nlp-simd --index ARCHIVE_DIR INDEX_FILE")
+				return 2
+			}
+			if err := runIndex(args[1], args[2]); err != nil {
+				fmt.Printf("❌ Error: %v\n", err)
+				return 1
+			}
+			return 0
+		case "--sweep":
+			if len(args) < 3 {
+				fmt.Println("❌ Usage: legal-nlp-simd --sweep INDEX_FILE PATTERN_FILE")
+				return 2
+			}
+			if err := runSweep(args[1], args[2]); err != nil {
+				fmt.Printf("❌ Error: %v\n", err)
+				return 1
+			}
+			return 0
+		case "--posindex":
+			if len(args) < 3 {
+				fmt.Println("❌ Usage: legal-nlp-simd --posindex ARCHIVE_DIR INDEX_FILE [PATTERN_FILE]")
+				return 2
+			}
+			patternFile := ""
+			if len(args) > 3 {
+				patternFile = args[3]
+			}
+			if err := runPositionIndex(args[1], args[2], patternFile); err != nil {
+				fmt.Printf("❌ Error: %v\n", err)
+				return 1
+			}
+			return 0
+		case "--query":
+			if len(args) < 2 {
+				fmt.Println("❌ Usage: legal-nlp-simd --query INDEX_FILE [speaker=S] [pattern=P] [doc=D]")
+				return 2
+			}
+			if err := runPositionQuery(args[1], args[2:]); err != nil {
+				fmt.Printf("❌ Error: %v\n", err)
+				return 1
+			}
+			return 0
+		case "--fmindex":
+			if len(args) < 3 {
+				fmt.Println("❌ Usage: legal-nlp-simd --fmindex ARCHIVE_DIR INDEX_FILE")
+				return 2
+			}
+			if err := runFMIndex(args[1], args[2]); err != nil {
+				fmt.Printf("❌ Error: %v\n", err)
+				return 1
+			}
+			return 0
+		case "--phrase":
+			if len(args) < 3 {
+				fmt.Println("❌ Usage: legal-nlp-simd --phrase INDEX_FILE PHRASE [LIMIT]")
+				return 2
+			}
+			limit := ""
+			if len(args) > 3 {
+				limit = args[3]
+			}
+			if err := runPhrase(args[1], args[2], limit); err != nil {
+				fmt.Printf("❌ Error: %v\n", err)
+				return 1
+			}
+			return 0
+		case "--revisions":
+			if len(args) < 2 {
+				fmt.Println("❌ Usage: legal-nlp-simd --revisions FILE [FILE...]")
+				return 2
+			}
+			if err := runRevisions(args[1:]); err != nil {
+				fmt.Printf("❌ Error: %v\n", err)
+				return 1
+			}
+			return 0
+		case "--ingest":
+			if len(args) < 2 {
+				fmt.Println("❌ Usage: legal-nlp-simd --ingest DIR")
+				return 2
+			}
+			if err := runIngest(args[1]); err != nil {
+				fmt.Printf("❌ Error: %v\n", err)
+				return 1
+			}
+			return 0
+		case "--zscan":
+			if len(args) < 2 {
+				fmt.Println("❌ Usage: legal-nlp-simd --zscan FILE [FILE...]")
+				return 2
+			}
+			if err := runStreamScan(args[1:]); err != nil {
+				fmt.Printf("❌ Error: %v\n", err)
+				return 1
+			}
+			return 0
+		case "--arrow":
+			if len(args) < 3 {
+				fmt.Println("❌ Usage: legal-nlp-simd --arrow DIR OUT [PATTERN_FILE]")
+				return 2
+			}
+			patternPath := ""
+			if len(args) > 3 {
+				patternPath = args[3]
+			}
+			if err := runArrowExport(args[1], args[2], patternPath); err != nil {
+				fmt.Printf("❌ Error: %v\n", err)
+				return 1
+			}
+			return 0
+		case "--jsonl":
+			field := "text"
+			if len(args) > 1 {
+				field = args[1]
+			}
+			if err := runJSONL(field); err != nil {
+				fmt.Fprintf(os.Stderr, "❌ Error: %v\n", err)
+				return 1
+			}
+			return 0
+		case "--dump":
+			if len(args) < 2 || (len(args) > 2 && args[2] != "--binary") {
+				fmt.Fprintln(os.Stderr, "❌ Usage: legal-nlp-simd --dump DIR [--binary]")
+				return 2
+			}
+			format := ResultText
+			if len(args) > 2 {
+				format = ResultBinary
+			}
+			if err := runDump(args[1], format); err != nil {
+				fmt.Fprintf(os.Stderr, "❌ Error: %v\n", err)
+				return 1
+			}
+			return 0
 		case "--help", "-h":
 			fmt.Println("\nUsage:")
 			fmt.Println("  legal-nlp-simd                Interactive mode")
 			fmt.Println("  legal-nlp-simd --benchmark     Run performance benchmark")
 			fmt.Println("  legal-nlp-simd --test          Run test cases")
+			fmt.Println("  legal-nlp-simd --index DIR IDX Build a trigram index of an archive")
+			fmt.Println("  legal-nlp-simd --sweep IDX PAT Match a pattern file against indexed documents")
+			fmt.Println("  legal-nlp-simd --posindex DIR IDX [PAT]  Index match positions by pattern and speaker")
+			fmt.Println("  legal-nlp-simd --query IDX speaker=S pattern=P doc=D  Query a position index")
+			fmt.Println("  legal-nlp-simd --fmindex DIR IDX  Build an FM index for ad-hoc phrases")
+			fmt.Println("  legal-nlp-simd --phrase IDX TEXT [LIMIT]  Count and locate a phrase")
+			fmt.Println("  legal-nlp-simd --revisions FILE...  Rescan document revisions through the chunk memo")
+			fmt.Println("  legal-nlp-simd --ingest DIR   Match an archive, skipping work on near-duplicates")
+			fmt.Println("  legal-nlp-simd --zscan FILE... Scan gzip/bzip2 transcripts without decompressing to disk")
+			fmt.Println("  legal-nlp-simd --arrow DIR OUT [PAT]  Write an archive's matches as an Arrow IPC stream")
+			fmt.Println("  legal-nlp-simd --jsonl [FIELD] Match JSON Lines records from stdin (field \"text\")")
+			fmt.Println("  legal-nlp-simd --dump DIR [--binary]  Stream every match of an archive to stdout")
 			fmt.Println("  legal-nlp-simd --help          Show this help")
-			return
+			fmt.Println("\nProfiling (combine with any mode):")
+			fmt.Println("  --cpuprofile FILE              Write CPU profile")
+			fmt.Println("  --memprofile FILE              Write heap profile on exit")
+			fmt.Println("  --mutexprofile FILE            Write mutex contention profile on exit")
+			fmt.Println("  --blockprofile FILE            Write blocking profile on exit")
+			fmt.Println("  --trace FILE                   Write execution trace")
+			fmt.Println("  --pprof-addr HOST:PORT         Serve /debug/pprof/ endpoints")
+			return 0
 		}
 	}
 
@@ -282,7 +516,7 @@ func main() {
 		switch strings.ToLower(input) {
 		case "quit", "exit", "q":
 			fmt.Println("👋 Goodbye!")
-			return
+			return 0
 		case "stats", "s":
 			displayStats(matcher, totalSearches, totalMatches, totalTime)
 			continue
@@ -324,4 +558,5 @@ func main() {
 		}
 		fmt.Printf("📊 Searches: %d | Matches: %d%s\n\n", totalSearches, totalMatches, cached)
 	}
+	return 0
 }
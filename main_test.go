@@ -0,0 +1,107 @@
+package main
+
+import (
+	"math/rand"
+	"strings"
+	"testing"
+	"time"
+)
+
+// naiveMatches is the reference: every start whose bytes equal the
+// pattern under foldASCII
+func naiveMatches(text string, patterns []string) []MatchResult {
+	var results []MatchResult
+	for id, p := range patterns {
+		for i := 0; i+len(p) <= len(text); i++ {
+			k := 0
+			for k < len(p) && foldASCII(text[i+k]) == foldASCII(p[k]) {
+				k++
+			}
+			if k == len(p) {
+				results = append(results, MatchResult{Offset: uint64(i), Length: uint64(len(p)),
+					PatternID: uint32(id), Confidence: 95, Text: text[i : i+len(p)]})
+			}
+		}
+	}
+	return results
+}
+
+func TestAppendMatchesMatchesNaiveScan(t *testing.T) {
+	rng := rand.New(rand.NewSource(1))
+	pieces := []string{"he said", "HE SAID", "She Said", "told me", "İ", "Ⱥ", "ß", "é", " ", "h", "e", "S"}
+	m := NewPureMatcher()
+	for n := 0; n < 2000; n++ {
+		var b strings.Builder
+		for b.Len() < n%200 {
+			b.WriteString(pieces[rng.Intn(len(pieces))])
+		}
+		text := b.String()
+		got := m.SearchUncached(text)
+		want := naiveMatches(text, LegalPatterns)
+		if len(got) != len(want) {
+			t.Fatalf("%q: %d matches, want %d", text, len(got), len(want))
+		}
+		for i := range got {
+			if got[i] != want[i] {
+				t.Fatalf("%q: match %d = %+v, want %+v", text, i, got[i], want[i])
+			}
+		}
+	}
+}
+
+// Case mappings that change byte length must not move offsets
+func TestAppendMatchesKeepsByteOffsets(t *testing.T) {
+	m := NewPureMatcher()
+	for _, tc := range []struct {
+		text   string
+		offset uint64
+	}{
+		{"ȺȺȺȺȺȺȺȺ he said", 17},
+		{"İİİİİİİİ HE SAID", 17},
+	} {
+		got := m.SearchUncached(tc.text)
+		if len(got) != 1 || got[0].Offset != tc.offset || !strings.EqualFold(got[0].Text, "he said") {
+			t.Errorf("%q: got %+v, want one match at %d", tc.text, got, tc.offset)
+		}
+	}
+}
+
+func TestAppendMatchesDoesNotAllocate(t *testing.T) {
+	m := NewPureMatcher()
+	text := strings.Repeat("The Witness SAID that He Told Me about ȺİÉ. ", 20)
+	results := m.AppendMatches(nil, text)
+	allocs := testing.AllocsPerRun(100, func() {
+		results = m.AppendMatches(results[:0], text)
+	})
+	if allocs != 0 {
+		t.Fatalf("AppendMatches: %.1f allocations per call", allocs)
+	}
+}
+
+// All-caps transcripts make the lower-case first byte rare; the scan must
+// stay linear rather than re-searching the rare case at every candidate
+func TestAppendMatchesAllCapsIsLinear(t *testing.T) {
+	m := NewPureMatcher()
+	text := strings.Repeat("THE WITNESS: WE WERE THERE. HE SAID SO. ", 1<<15) // 1.3 MB
+	got := m.SearchUncached(text)
+	want := naiveMatches(text, LegalPatterns)
+	if len(got) != len(want) {
+		t.Fatalf("%d matches, want %d", len(got), len(want))
+	}
+	for i := range got {
+		if got[i] != want[i] {
+			t.Fatalf("match %d = %+v, want %+v", i, got[i], want[i])
+		}
+	}
+
+	mixed := strings.ToLower(text)
+	timeScan := func(s string) time.Duration {
+		start := time.Now()
+		m.SearchUncached(s)
+		return time.Since(start)
+	}
+	timeScan(mixed) // Warm up
+	if caps, lower := timeScan(text), timeScan(mixed); caps > 10*lower+50*time.Millisecond {
+		t.Fatalf("all-caps scan took %v, lower-case %v", caps, lower)
+	}
+}
@@ -1,4 +1,9 @@
 #include "matcher.h"
+#include "roaring.h"
+#include "rabin_karp.h"
+#include "wu_manber.h"
+#include "jit.h"
+#include "patterns_gen.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -7,9 +12,12 @@
 #include <immintrin.h>
 #include <cpuid.h>
 #include <ctype.h>
+#include <pthread.h>
 
 // Forward declarations
 static uint64_t fallback_search(
+    const matcher_state_t* state,
+    matcher_scratch_t* scratch,
     const char* text,
     size_t text_len,
     match_result_t* results,
@@ -19,76 +27,238 @@ static uint64_t fallback_search(
 // Global matcher state (shared across FFI calls)
 static matcher_state_t g_matcher = {0};
 
-// Legal hearsay patterns (hardcoded for demo)
-static const char* legal_patterns[] = {
-    "he said",
-    "she said", 
-    "she told",
-    "he told",
-    "i heard",
-    "according to",
-    "reportedly",
-    "allegedly",
-    "it was reported",
-    "sources say",
-    "witnesses claim",
-    "testimony indicates",
-    "didn't you say",
-    "you mentioned",
-    "as stated by"
-};
-static const size_t num_legal_patterns = sizeof(legal_patterns) / sizeof(legal_patterns[0]);
+// Calibrated TSC clock (written once under g_tsc_once)
+static tsc_clock_t g_tsc = {0};
+static pthread_once_t g_tsc_once = PTHREAD_ONCE_INIT;
 
-// Initialize the matcher with legal hearsay patterns
-int matcher_init(matcher_state_t* state) {
+// Timestamp epoch: get_timestamp_ns extrapolates from the latest
+// CLOCK_MONOTONIC anchor and re-anchors it every TSC_RESYNC_NS so TSC drift
+// cannot accumulate. A re-anchor never moves the clock back: it starts from
+// the old epoch's projection when that is ahead and slews the rate to close
+// the gap over the next interval. Published under g_epoch_seq (odd while a
+// resync runs).
+typedef struct {
+    atomic_uint_fast64_t cycles;    // TSC reading at the anchor
+    atomic_uint_fast64_t ns;        // Timestamp at the anchor (>= mono)
+    atomic_uint_fast64_t mono;      // CLOCK_MONOTONIC at the anchor
+    atomic_uint_fast64_t mult;      // Fixed-point ns per cycle until the next anchor
+} tsc_epoch_t;
+static tsc_epoch_t g_epoch;
+static atomic_uint g_epoch_seq;
+static uint64_t g_resync_cycles;
+
+#define TSC_CALIBRATION_NS   10000000ULL    // 10ms per measurement round
+#define TSC_CALIBRATION_RUNS 3
+#define TSC_NS_SHIFT         32
+#define TSC_RESYNC_NS        1000000000ULL  // Re-anchor timestamps every second
+
+// Cache sizes assumed when neither CPUID nor sysfs describe the hierarchy
+#define DEFAULT_LINE_SIZE    64
+#define DEFAULT_L1D_SIZE     (32 * 1024)
+#define DEFAULT_L2_SIZE      (256 * 1024)
+#define DEFAULT_LLC_SIZE     (8 * 1024 * 1024)
+
+
+// Build the pattern table and engine for one pattern set
+static int matcher_init_table(
+    matcher_state_t* state,
+    const char* const* patterns,
+    const uint32_t* categories,
+    size_t count,
+    bool builtin
+) {
     if (state->initialized) {
         return 0; // Already initialized
     }
+    if (count == 0) {
+        return -1;
+    }
     
     // Detect CPU features
     state->avx512_available = detect_avx512_support();
+    timing_init();
+    
+    // Size scan blocks to this host's caches
+    detect_cache_topology(&state->cache);
+    derive_matcher_tuning(&state->cache, &state->tuning);
     
-    // Allocate 64-byte aligned buffer for SIMD patterns
-    state->pattern_buffer_size = num_legal_patterns * 64; // 64 bytes per pattern
-    state->pattern_buffer = aligned_alloc_64(state->pattern_buffer_size);
-    if (!state->pattern_buffer) {
+    // Pattern metadata as one structure-of-arrays block
+    pattern_table_t* table = pattern_table_build(patterns, categories, count);
+    if (!table) {
         return -1;
     }
     
-    // Zero out the buffer
-    memset(state->pattern_buffer, 0, state->pattern_buffer_size);
-    
-    // Compile patterns to SIMD format
-    char* pattern_ptr = (char*)state->pattern_buffer;
-    for (size_t i = 0; i < num_legal_patterns; i++) {
-        compile_pattern_to_simd(legal_patterns[i], pattern_ptr);
-        pattern_ptr += 64; // Next 64-byte aligned slot
+    state->pattern_buffer = table;
+    state->pattern_buffer_size = table->total_size;
+    state->pattern_count = table->count;
+    state->max_pattern_len = table->max_len;
+    state->builtin_patterns = builtin;
+    state->active_engine = matcher_select_engine(state);
+    if (state->active_engine == MATCHER_ENGINE_JIT) {
+        state->jit = jit_compile(table);
+        if (!state->jit) state->active_engine = MATCHER_ENGINE_PREFILTER;
     }
     
-    state->pattern_count = num_legal_patterns;
-    
     // Initialize atomic counters
-    atomic_store(&state->stats.total_searches, 0);
-    atomic_store(&state->stats.total_matches, 0);
-    atomic_store(&state->stats.cache_hits, 0);
-    atomic_store(&state->stats.cache_misses, 0);
-    atomic_store(&state->stats.simd_operations, 0);
-    atomic_store(&state->stats.fallback_operations, 0);
+    reset_performance_stats(state);
     
     state->initialized = true;
     
-    printf("🚀 Matcher initialized: %zu patterns, AVX-512: %s\n", 
-           num_legal_patterns, state->avx512_available ? "YES" : "NO");
+    printf("🚀 Matcher initialized: %u patterns, AVX-512: %s, engine: %s\n", 
+           state->pattern_count, state->avx512_available ? "YES" : "NO",
+           matcher_engine_name(state->active_engine));
+    printf("🧠 Cache: L1d %uK, L2 %uK, LLC %uK, line %uB\n",
+           state->cache.l1d_size / 1024, state->cache.l2_size / 1024,
+           state->cache.llc_size / 1024, state->cache.line_size);
     
     return 0;
 }
 
+// Initialize the matcher with legal hearsay patterns
+int matcher_init(matcher_state_t* state) {
+    const char* texts[LEGAL_PATTERN_COUNT];
+    uint32_t categories[LEGAL_PATTERN_COUNT];
+    for (size_t i = 0; i < LEGAL_PATTERN_COUNT; i++) {
+        texts[i] = legal_patterns[i].text;
+        categories[i] = legal_patterns[i].category;
+    }
+    return matcher_init_table(state, texts, categories, LEGAL_PATTERN_COUNT, true);
+}
+
+int matcher_init_patterns(
+    matcher_state_t* state,
+    const char* const* patterns,
+    const uint32_t* categories,
+    size_t count
+) {
+    return matcher_init_table(state, patterns, categories, count, false);
+}
+
+// Category names used by patterns/legal_patterns.txt
+static uint32_t category_from_name(const char* name) {
+    if (strcmp(name, "attribution") == 0) return PATTERN_CAT_ATTRIBUTION;
+    if (strcmp(name, "secondhand") == 0) return PATTERN_CAT_SECONDHAND;
+    if (strcmp(name, "reported") == 0) return PATTERN_CAT_REPORTED;
+    if (strcmp(name, "impeachment") == 0) return PATTERN_CAT_IMPEACHMENT;
+    return 0;
+}
+
+// Load a "<category> <phrase>" file (the generator's format) as a custom set
+int load_legal_patterns(matcher_state_t* state, const char* patterns_file) {
+    FILE* f = fopen(patterns_file, "r");
+    if (!f) {
+        return -1;
+    }
+    
+    char** texts = NULL;
+    uint32_t* categories = NULL;
+    size_t count = 0, capacity = 0;
+    char* line = NULL;
+    size_t line_cap = 0;
+    int rc = 0;
+    while (getline(&line, &line_cap, f) >= 0) {
+        char* p = line;
+        while (isspace((unsigned char)*p)) p++;
+        if (*p == '\0' || *p == '#') continue;
+        
+        char* name = p;
+        while (*p && !isspace((unsigned char)*p)) p++;
+        if (*p) *p++ = '\0';
+        while (isspace((unsigned char)*p)) p++;
+        char* end = p + strlen(p);
+        while (end > p && isspace((unsigned char)end[-1])) end--;
+        *end = '\0';
+        uint32_t category = category_from_name(name);
+        if (*p == '\0' || category == 0) {
+            rc = -1;    // Not "<category> <phrase>"
+            break;
+        }
+        
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            char** grown_texts = realloc(texts, capacity * sizeof(*texts));
+            if (grown_texts) texts = grown_texts;
+            uint32_t* grown_categories = realloc(categories, capacity * sizeof(*categories));
+            if (grown_categories) categories = grown_categories;
+            if (!grown_texts || !grown_categories) {
+                rc = -1;
+                break;
+            }
+        }
+        texts[count] = strdup(p);
+        if (!texts[count]) {
+            rc = -1;
+            break;
+        }
+        categories[count++] = category;
+    }
+    free(line);
+    fclose(f);
+    
+    if (rc == 0) {
+        rc = matcher_init_patterns(state, (const char* const*)texts, categories, count);
+    }
+    for (size_t i = 0; i < count; i++) free(texts[i]);
+    free(texts);
+    free(categories);
+    return rc;
+}
+
+matcher_engine_t matcher_select_engine(const matcher_state_t* state) {
+    const pattern_table_t* table = matcher_pattern_table(state);
+    bool avx2 = detect_avx2_support();
+    bool simd = state->avx512_available || avx2;
+    
+    switch (state->engine) {
+    case MATCHER_ENGINE_SIMD:
+        // Generated kernels only know the compiled-in patterns
+        return simd && state->builtin_patterns ? MATCHER_ENGINE_SIMD : MATCHER_ENGINE_PREFILTER;
+    case MATCHER_ENGINE_RABIN_KARP:
+        return avx2 ? MATCHER_ENGINE_RABIN_KARP : MATCHER_ENGINE_PREFILTER;
+    case MATCHER_ENGINE_WU_MANBER:
+        return avx2 && table->wm_block ? MATCHER_ENGINE_WU_MANBER : MATCHER_ENGINE_PREFILTER;
+    case MATCHER_ENGINE_JIT:
+        // Compiled by matcher_init, which falls back if that fails
+        return avx2 && table->count <= JIT_MAX_PATTERNS && table->max_len <= JIT_MAX_LENGTH
+            ? MATCHER_ENGINE_JIT : MATCHER_ENGINE_PREFILTER;
+    case MATCHER_ENGINE_PREFILTER:
+        return MATCHER_ENGINE_PREFILTER;
+    case MATCHER_ENGINE_AUTO:
+        break;
+    }
+    
+    if (simd && state->builtin_patterns) return MATCHER_ENGINE_SIMD;
+    // Only long patterns: skipping ahead beats touching every byte
+    if (avx2 && table->wm_block && table->min_len >= WM_AUTO_MIN_LENGTH) {
+        return MATCHER_ENGINE_WU_MANBER;
+    }
+    // Large lexicons of medium-length phrases: hashing beats bucket scans
+    if (avx2 && table->count >= RK_AUTO_MIN_PATTERNS && table->min_len >= RK_AUTO_MIN_LENGTH) {
+        return MATCHER_ENGINE_RABIN_KARP;
+    }
+    return MATCHER_ENGINE_PREFILTER;
+}
+
+const char* matcher_engine_name(matcher_engine_t engine) {
+    switch (engine) {
+    case MATCHER_ENGINE_AUTO:       return "auto";
+    case MATCHER_ENGINE_SIMD:       return "simd";
+    case MATCHER_ENGINE_PREFILTER:  return "prefilter";
+    case MATCHER_ENGINE_RABIN_KARP: return "rabin-karp";
+    case MATCHER_ENGINE_WU_MANBER:  return "wu-manber";
+    case MATCHER_ENGINE_JIT:        return "jit";
+    }
+    return "unknown";
+}
+
 // Cleanup matcher resources
 void matcher_cleanup(matcher_state_t* state) {
     if (state->pattern_buffer) {
         aligned_free(state->pattern_buffer);
         state->pattern_buffer = NULL;
     }
+    jit_free(state->jit);
+    state->jit = NULL;
     state->initialized = false;
 }
 
@@ -99,6 +269,21 @@ int search_patterns(
     size_t text_len,
     match_result_t* results,
     size_t max_results
+) {
+    matcher_scratch_t* scratch = matcher_thread_scratch();
+    if (!scratch) {
+        return -1;
+    }
+    return search_patterns_scratch(state, scratch, text, text_len, results, max_results);
+}
+
+int search_patterns_scratch(
+    matcher_state_t* state,
+    matcher_scratch_t* scratch,
+    const char* text,
+    size_t text_len,
+    match_result_t* results,
+    size_t max_results
 ) {
     if (!state->initialized) {
         return -1;
@@ -109,50 +294,143 @@ int search_patterns(
     
     uint64_t start_cycles = get_cpu_cycles();
     
-    // Call assembly SIMD core
+    // Dispatch to the engine chosen at init
     uint64_t match_count;
-    if (state->avx512_available) {
+    bool utf8_valid;
+    switch (state->active_engine) {
+    case MATCHER_ENGINE_SIMD:
         atomic_fetch_add(&state->stats.simd_operations, 1);
-        match_count = simd_search_patterns(text, text_len, results);
-    } else {
+        match_count = simd_search_patterns(text, text_len, results, max_results, state->whole_words,
+                                           &utf8_valid);
+        if (!utf8_valid) atomic_fetch_add(&state->stats.invalid_utf8, 1);
+        break;
+    case MATCHER_ENGINE_RABIN_KARP:
+        atomic_fetch_add(&state->stats.simd_operations, 1);
+        match_count = rk_search(matcher_pattern_table(state), scratch, state->whole_words,
+                                text, text_len, results, max_results);
+        break;
+    case MATCHER_ENGINE_WU_MANBER:
+        atomic_fetch_add(&state->stats.simd_operations, 1);
+        match_count = wm_search(matcher_pattern_table(state), state->whole_words,
+                                text, text_len, results, max_results);
+        break;
+    case MATCHER_ENGINE_JIT:
+        atomic_fetch_add(&state->stats.simd_operations, 1);
+        match_count = jit_search(state->jit, matcher_pattern_table(state), state->whole_words,
+                                 text, text_len, results, max_results);
+        break;
+    default:
         atomic_fetch_add(&state->stats.fallback_operations, 1);
-        // Fallback to simple string search
-        match_count = fallback_search(text, text_len, results, max_results);
+        match_count = fallback_search(state, scratch, text, text_len, results, max_results);
+        break;
     }
     
-    uint64_t end_cycles = get_cpu_cycles();
+    uint64_t end_cycles = get_cpu_cycles_end();
+    if (match_count == MATCHER_SEARCH_FAILED) {
+        return -1;
+    }
     
-    // Update match counter
+    // Update match and latency counters
     atomic_fetch_add(&state->stats.total_matches, match_count);
+    atomic_fetch_add(&state->stats.total_cycles, end_cycles - start_cycles);
     
     return (int)match_count;
 }
 
 // Fallback search for non-AVX512 systems
+// Two stages per L1-sized block: a pair-filter prefilter records candidate
+// offsets in a roaring set held in the scratch arena, then candidates are
+// verified while the block is still cached. Dense spans switch to bitmap
+// containers, so match-heavy documents cost 1 bit per position instead of 8
+// bytes. With whole_words set, each block's candidates are ANDed with its
+// word-start bitmap before verification. Results come out in offset order.
+// Verification only reads the current span's container, so the arena is
+// reset at every 64K span and memory stays flat whatever the text size.
+// Lengths and last bytes are checked from their own dense arrays before the
+// full compare touches the string pool; the table lives in the pattern
+// buffer, so per-node replicas are what the scan touches.
 static uint64_t fallback_search(
+    const matcher_state_t* state,
+    matcher_scratch_t* scratch,
     const char* text,
     size_t text_len,
     match_result_t* results,
     size_t max_results
 ) {
+    const uint8_t* bytes = (const uint8_t*)text;
+    const pattern_table_t* table = matcher_pattern_table(state);
+    const uint64_t* filter = pt_pair_filter(table);
+    const uint32_t* buckets = pt_buckets(table);
+    const uint32_t* ids = pt_bucket_ids(table);
+    const uint16_t* lengths = pt_lengths(table);
+    const uint8_t* last_bytes = pt_last_bytes(table);
+    
+    roaring_t candidates;
+    uint64_t* boundaries = NULL;
+    
     uint64_t match_count = 0;
+    size_t block_size = state->tuning.scan_block_size;
     
-    for (size_t i = 0; i < num_legal_patterns && match_count < max_results; i++) {
-        const char* pattern = legal_patterns[i];
-        size_t pattern_len = strlen(pattern);
+    for (size_t block = 0; block < text_len && match_count < max_results; ) {
+        // Blocks never straddle a 64K container
+        size_t block_end = block + block_size;
+        size_t span_end = (block | 0xFFFF) + 1;
+        if (block_end > span_end) block_end = span_end;
+        if (block_end > text_len) block_end = text_len;
+        uint64_t span_base = block & ~(size_t)0xFFFF;
+        uint32_t lo = (uint32_t)(block - span_base);
+        uint32_t hi = (uint32_t)(block_end - span_base);
+        
+        // New span: earlier containers are never read again
+        if (lo == 0) {
+            arena_reset(&scratch->arena);
+            roaring_init(&candidates, &scratch->arena);
+            if (state->whole_words) {
+                boundaries = arena_alloc(&scratch->arena, ROARING_BITMAP_WORDS * sizeof(uint64_t));
+                if (!boundaries) return MATCHER_SEARCH_FAILED;
+            }
+        }
+        
+        // Stage 1: prefilter on the first two folded bytes
+        for (size_t j = block; j < block_end; j++) {
+            unsigned second = j + 1 < text_len ? fold_byte(bytes[j + 1]) : 0;
+            unsigned pair = (unsigned)fold_byte(bytes[j]) << 8 | second;
+            if (filter[pair >> 6] & (1ULL << (pair & 63))) {
+                if (!roaring_append(&candidates, j)) return MATCHER_SEARCH_FAILED;
+            }
+        }
         
-        // Simple Boyer-Moore-like search
-        for (size_t j = 0; j <= text_len - pattern_len; j++) {
-            if (strncasecmp(&text[j], pattern, pattern_len) == 0) {
+        if (boundaries) {
+            word_start_bits(text, text_len, span_base, lo, hi, boundaries);
+            roaring_and_last(&candidates, boundaries, lo, hi);
+        }
+        
+        // Stage 2: verify this block's candidates against their bucket
+        roaring_iter_t it;
+        uint64_t j;
+        roaring_iter_last(&candidates, &it, lo, hi);
+        while (match_count < max_results && roaring_iter_next(&it, &j)) {
+            uint8_t first = fold_byte(bytes[j]);
+            for (uint32_t k = buckets[first]; k < buckets[first + 1]; k++) {
+                uint32_t id = ids[k];
+                size_t pattern_len = lengths[id];
+                if (pattern_len > text_len - j) continue;
+                if (fold_byte(bytes[j + pattern_len - 1]) != last_bytes[id]) continue;
+                if (!folded_equal(bytes + j, pt_pattern(table, id), pattern_len)) continue;
+                if (boundaries && j + pattern_len < text_len &&
+                    is_word_byte(bytes[j + pattern_len - 1]) && is_word_byte(bytes[j + pattern_len])) {
+                    continue;   // Runs into the next word
+                }
+                
                 results[match_count].offset = j;
                 results[match_count].length = pattern_len;
-                results[match_count].pattern_id = i;
+                results[match_count].pattern_id = id;
                 results[match_count].confidence = 95; // Fixed confidence for demo
-                match_count++;
-                
-                if (match_count >= max_results) break;
+                if (++match_count >= max_results) break;
             }
         }
+        
+        block = block_end;
     }
     
     return match_count;
@@ -222,6 +500,135 @@ const char* get_cpu_features(void) {
     return features;
 }
 
+// Fill one cache level from a CPUID leaf 4 / 0x8000001D descriptor
+static void apply_cache_descriptor(cache_topology_t* topo, unsigned int eax,
+                                   unsigned int ebx, unsigned int ecx) {
+    unsigned int type = eax & 0x1f;            // 1 = data, 2 = instruction, 3 = unified
+    unsigned int level = (eax >> 5) & 0x7;
+    if (type == 2) return;
+    
+    uint32_t line = (ebx & 0xfff) + 1;
+    uint32_t partitions = ((ebx >> 12) & 0x3ff) + 1;
+    uint32_t ways = ((ebx >> 22) & 0x3ff) + 1;
+    uint32_t sets = ecx + 1;
+    uint32_t size = ways * partitions * line * sets;
+    
+    if (topo->line_size == 0) topo->line_size = line;
+    if (level == 1) {
+        topo->l1d_size = size;
+    } else if (level == 2) {
+        topo->l2_size = size;
+    }
+    if (level >= 2 && size >= topo->llc_size) {
+        topo->llc_size = size;
+        topo->llc_sharing = ((eax >> 14) & 0xfff) + 1;
+    }
+}
+
+// Deterministic cache parameters: leaf 4 (Intel) or 0x8000001D (AMD)
+static bool cache_topology_from_cpuid(cache_topology_t* topo) {
+    unsigned int eax, ebx, ecx, edx;
+    __cpuid(0, eax, ebx, ecx, edx);
+    unsigned int max_leaf = eax;
+    bool amd = (ebx == 0x68747541);            // "Auth"enticAMD
+    
+    unsigned int leaf = 4;
+    if (amd) {
+        __cpuid(0x80000000, eax, ebx, ecx, edx);
+        if (eax < 0x8000001D) return false;
+        __cpuid(0x80000001, eax, ebx, ecx, edx);
+        if (!(ecx & (1u << 22))) return false; // No topology extensions
+        leaf = 0x8000001D;
+    } else if (max_leaf < 4) {
+        return false;
+    }
+    
+    for (unsigned int sub = 0; sub < 16; sub++) {
+        __cpuid_count(leaf, sub, eax, ebx, ecx, edx);
+        if ((eax & 0x1f) == 0) break;          // No more caches
+        apply_cache_descriptor(topo, eax, ebx, ecx);
+    }
+    return topo->l1d_size != 0;
+}
+
+static uint32_t read_sysfs_uint(const char* path, bool size_suffix) {
+    FILE* f = fopen(path, "r");
+    if (!f) return 0;
+    
+    unsigned long value = 0;
+    char suffix = 0;
+    int n = fscanf(f, "%lu%c", &value, &suffix);
+    fclose(f);
+    if (n < 1) return 0;
+    
+    if (size_suffix && n == 2) {
+        if (suffix == 'K') value *= 1024;
+        else if (suffix == 'M') value *= 1024 * 1024;
+    }
+    return (uint32_t)value;
+}
+
+// Linux fallback: /sys/devices/system/cpu/cpu0/cache/index*/
+static bool cache_topology_from_sysfs(cache_topology_t* topo) {
+    char path[128];
+    char type[32];
+    
+    for (int index = 0; index < 16; index++) {
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/type", index);
+        FILE* f = fopen(path, "r");
+        if (!f) break;
+        int n = fscanf(f, "%31s", type);
+        fclose(f);
+        if (n != 1 || strcmp(type, "Instruction") == 0) continue;
+        
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/level", index);
+        uint32_t level = read_sysfs_uint(path, false);
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/size", index);
+        uint32_t size = read_sysfs_uint(path, true);
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/coherency_line_size", index);
+        uint32_t line = read_sysfs_uint(path, false);
+        
+        if (topo->line_size == 0) topo->line_size = line;
+        if (level == 1) topo->l1d_size = size;
+        else if (level == 2) topo->l2_size = size;
+        if (level >= 2 && size >= topo->llc_size) topo->llc_size = size;
+    }
+    return topo->l1d_size != 0;
+}
+
+int detect_cache_topology(cache_topology_t* topo) {
+    memset(topo, 0, sizeof(*topo));
+    
+    bool found = cache_topology_from_cpuid(topo);
+    if (!found) {
+        memset(topo, 0, sizeof(*topo));
+        found = cache_topology_from_sysfs(topo);
+    }
+    
+    // Fill whatever neither source reported
+    if (topo->line_size == 0) topo->line_size = DEFAULT_LINE_SIZE;
+    if (topo->l1d_size == 0) topo->l1d_size = DEFAULT_L1D_SIZE;
+    if (topo->l2_size == 0) topo->l2_size = DEFAULT_L2_SIZE;
+    if (topo->llc_size == 0) topo->llc_size = DEFAULT_LLC_SIZE;
+    if (topo->llc_sharing == 0) topo->llc_sharing = 1;
+    
+    return found ? 0 : -1;
+}
+
+static size_t round_down_to(size_t value, size_t multiple) {
+    return value - value % multiple;
+}
+
+void derive_matcher_tuning(const cache_topology_t* topo, matcher_tuning_t* tuning) {
+    // Half of L1d for the text block; the rest holds pattern data and stack
+    size_t block = round_down_to(topo->l1d_size / 2, topo->line_size);
+    tuning->scan_block_size = block < 4096 ? 4096 : block;
+    
+    // A worker's span should stay L2-resident while it is being verified
+    size_t chunk = round_down_to(topo->l2_size / 2, tuning->scan_block_size);
+    tuning->parallel_chunk_size = chunk < tuning->scan_block_size ? tuning->scan_block_size : chunk;
+}
+
 // Performance statistics
 void get_performance_stats(matcher_state_t* state, perf_stats_t* stats) {
     stats->total_searches = atomic_load(&state->stats.total_searches);
@@ -230,6 +637,8 @@ void get_performance_stats(matcher_state_t* state, perf_stats_t* stats) {
     stats->cache_misses = atomic_load(&state->stats.cache_misses);
     stats->simd_operations = atomic_load(&state->stats.simd_operations);
     stats->fallback_operations = atomic_load(&state->stats.fallback_operations);
+    stats->total_cycles = atomic_load(&state->stats.total_cycles);
+    stats->invalid_utf8 = atomic_load(&state->stats.invalid_utf8);
 }
 
 void reset_performance_stats(matcher_state_t* state) {
@@ -239,6 +648,8 @@ void reset_performance_stats(matcher_state_t* state) {
     atomic_store(&state->stats.cache_misses, 0);
     atomic_store(&state->stats.simd_operations, 0);
     atomic_store(&state->stats.fallback_operations, 0);
+    atomic_store(&state->stats.total_cycles, 0);
+    atomic_store(&state->stats.invalid_utf8, 0);
 }
 
 // Pattern compilation to SIMD format
@@ -270,15 +681,201 @@ void aligned_free(void* ptr) {
 }
 
 // Timing utilities
-uint64_t get_timestamp_ns(void) {
+static uint64_t monotonic_ns(void) {
     struct timespec ts;
     clock_gettime(CLOCK_MONOTONIC, &ts);
     return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
 }
 
-uint64_t get_cpu_cycles(void) {
+static inline uint64_t rdtsc_fenced(void) {
     unsigned int lo, hi;
-    __asm__ __volatile__("rdtsc" : "=a" (lo), "=d" (hi));
+    // LFENCE keeps earlier instructions from being timed after the read
+    __asm__ __volatile__("lfence\n\trdtsc" : "=a" (lo), "=d" (hi) :: "memory");
+    return ((uint64_t)hi << 32) | lo;
+}
+
+// Exact TSC frequency from CPUID leaf 0x15 (0 if not enumerated)
+static uint64_t tsc_hz_from_cpuid(void) {
+    unsigned int eax, ebx, ecx, edx;
+    __cpuid(0, eax, ebx, ecx, edx);
+    if (eax < 0x15) return 0;
+
+    __cpuid(0x15, eax, ebx, ecx, edx);   // EAX/EBX = TSC/crystal ratio, ECX = crystal Hz
+    if (eax == 0 || ebx == 0 || ecx == 0) return 0;
+    return (uint64_t)ecx * ebx / eax;
+}
+
+// Measure TSC frequency against CLOCK_MONOTONIC, keeping the tightest round
+static uint64_t tsc_hz_measure(void) {
+    uint64_t best_hz = 0;
+    uint64_t best_overhead = UINT64_MAX;
+
+    for (int run = 0; run < TSC_CALIBRATION_RUNS; run++) {
+        uint64_t c0 = rdtsc_fenced();
+        uint64_t t0 = monotonic_ns();
+        uint64_t c1 = rdtsc_fenced();
+
+        uint64_t t_end;
+        do {
+            t_end = monotonic_ns();
+        } while (t_end - t0 < TSC_CALIBRATION_NS);
+        uint64_t c2 = rdtsc_fenced();
+        uint64_t t2 = monotonic_ns();
+        uint64_t c3 = rdtsc_fenced();
+
+        // Bracket each clock_gettime between two TSC reads; use midpoints
+        uint64_t overhead = (c1 - c0) + (c3 - c2);
+        uint64_t cycles = (c2 + c3) / 2 - (c0 + c1) / 2;
+        uint64_t ns = t2 - t0;
+        if (ns == 0) continue;
+
+        if (overhead < best_overhead) {
+            best_overhead = overhead;
+            best_hz = (uint64_t)((unsigned __int128)cycles * 1000000000ULL / ns);
+        }
+    }
+    return best_hz;
+}
+
+// Pair a CLOCK_MONOTONIC reading with the TSC at its midpoint
+static uint64_t tsc_anchor(uint64_t* ns) {
+    uint64_t c0 = rdtsc_fenced();
+    *ns = monotonic_ns();
+    uint64_t c1 = rdtsc_fenced();
+    return c0 + (c1 - c0) / 2;
+}
+
+static void tsc_calibrate(void) {
+    unsigned int eax, ebx, ecx, edx;
+
+    __cpuid(0x80000000, eax, ebx, ecx, edx);
+    unsigned int max_ext = eax;
+    if (max_ext >= 0x80000001) {
+        __cpuid(0x80000001, eax, ebx, ecx, edx);
+        g_tsc.has_rdtscp = (edx & (1u << 27)) != 0;
+    }
+    if (max_ext >= 0x80000007) {
+        __cpuid(0x80000007, eax, ebx, ecx, edx);
+        g_tsc.invariant = (edx & (1u << 8)) != 0;
+    }
+
+    // A variable-rate TSC cannot stand in for wall time
+    if (!g_tsc.invariant) return;
+
+    uint64_t hz = tsc_hz_from_cpuid();
+    if (hz == 0) hz = tsc_hz_measure();
+    if (hz == 0) return;
+
+    g_tsc.tsc_hz = hz;
+    g_tsc.ns_shift = TSC_NS_SHIFT;
+    g_tsc.ns_mult = (uint64_t)((((unsigned __int128)1000000000ULL << TSC_NS_SHIFT) + hz / 2) / hz);
+    g_tsc.base_cycles = tsc_anchor(&g_tsc.base_ns);
+
+    atomic_store_explicit(&g_epoch.cycles, g_tsc.base_cycles, memory_order_relaxed);
+    atomic_store_explicit(&g_epoch.ns, g_tsc.base_ns, memory_order_relaxed);
+    atomic_store_explicit(&g_epoch.mono, g_tsc.base_ns, memory_order_relaxed);
+    atomic_store_explicit(&g_epoch.mult, g_tsc.ns_mult, memory_order_relaxed);
+    g_resync_cycles = (uint64_t)((unsigned __int128)hz * TSC_RESYNC_NS / 1000000000ULL);
+    g_tsc.calibrated = true;
+}
+
+int timing_init(void) {
+    pthread_once(&g_tsc_once, tsc_calibrate);
+    return g_tsc.calibrated ? 0 : -1;
+}
+
+const tsc_clock_t* get_tsc_clock(void) {
+    return &g_tsc;
+}
+
+uint64_t cycles_to_ns(uint64_t cycles) {
+    if (!g_tsc.calibrated) {
+        return 0;  // Cycles have no known duration without a TSC rate
+    }
+    return (uint64_t)(((unsigned __int128)cycles * g_tsc.ns_mult) >> g_tsc.ns_shift);
+}
+
+static inline uint64_t epoch_project(uint64_t base_ns, uint64_t elapsed, uint64_t mult) {
+    return base_ns + (uint64_t)(((unsigned __int128)elapsed * mult) >> g_tsc.ns_shift);
+}
+
+// Move the epoch to a fresh CLOCK_MONOTONIC anchor; the caller owns the odd
+// sequence value and passes the epoch it replaces
+static uint64_t tsc_resync(uint64_t old_cycles, uint64_t old_ns, uint64_t old_mono,
+                           uint64_t old_mult, unsigned int seq) {
+    uint64_t mono;
+    uint64_t cycles = tsc_anchor(&mono);
+
+    // Rate over the interval just ended, then slowed so a timestamp that
+    // ran ahead of CLOCK_MONOTONIC meets it again by the next anchor
+    uint64_t ns = epoch_project(old_ns, cycles - old_cycles, old_mult);
+    uint64_t mult = old_mult;
+    if (cycles > old_cycles && mono > old_mono) {
+        mult = (uint64_t)(((unsigned __int128)(mono - old_mono) << g_tsc.ns_shift) / (cycles - old_cycles));
+    }
+    if (ns < mono) {
+        ns = mono;
+    } else {
+        uint64_t lead = ns - mono < TSC_RESYNC_NS / 2 ? ns - mono : TSC_RESYNC_NS / 2;
+        mult = (uint64_t)((unsigned __int128)mult * (TSC_RESYNC_NS - lead) / TSC_RESYNC_NS);
+    }
+
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&g_epoch.cycles, cycles, memory_order_relaxed);
+    atomic_store_explicit(&g_epoch.ns, ns, memory_order_relaxed);
+    atomic_store_explicit(&g_epoch.mono, mono, memory_order_relaxed);
+    atomic_store_explicit(&g_epoch.mult, mult, memory_order_relaxed);
+    atomic_store_explicit(&g_epoch_seq, seq + 1, memory_order_release);
+    return ns;
+}
+
+// Monotonic across threads: the TSC is read inside the sequence check, so
+// a reader using an epoch read its TSC before that epoch was replaced, and
+// every new epoch starts at or after the old one's projection
+uint64_t get_timestamp_ns(void) {
+    if (!g_tsc.calibrated) {
+        return monotonic_ns();
+    }
+
+    for (;;) {
+        unsigned int seq = atomic_load_explicit(&g_epoch_seq, memory_order_acquire);
+        if (seq & 1) {
+            _mm_pause();  // Another thread is re-anchoring
+            continue;
+        }
+        uint64_t base_cycles = atomic_load_explicit(&g_epoch.cycles, memory_order_relaxed);
+        uint64_t base_ns = atomic_load_explicit(&g_epoch.ns, memory_order_relaxed);
+        uint64_t base_mono = atomic_load_explicit(&g_epoch.mono, memory_order_relaxed);
+        uint64_t mult = atomic_load_explicit(&g_epoch.mult, memory_order_relaxed);
+        uint64_t now = rdtsc_fenced();
+        _mm_lfence();  // The re-check below must not run before the TSC read
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&g_epoch_seq, memory_order_relaxed) != seq) {
+            continue;
+        }
+
+        uint64_t elapsed = now - base_cycles;
+        if (elapsed >= g_resync_cycles &&
+            atomic_compare_exchange_strong(&g_epoch_seq, &seq, seq + 1)) {
+            return tsc_resync(base_cycles, base_ns, base_mono, mult, seq + 1);
+        }
+        return epoch_project(base_ns, elapsed, mult);
+    }
+}
+
+uint64_t get_cpu_cycles(void) {
+    return rdtsc_fenced();
+}
+
+uint64_t get_cpu_cycles_end(void) {
+    unsigned int lo, hi, aux;
+    if (!g_tsc.has_rdtscp) {
+        uint64_t cycles = rdtsc_fenced();
+        __asm__ __volatile__("lfence" ::: "memory");
+        return cycles;
+    }
+    // RDTSCP waits for prior instructions; LFENCE stops later ones starting early
+    __asm__ __volatile__("rdtscp\n\tlfence" : "=a" (lo), "=d" (hi), "=c" (aux) :: "memory");
     return ((uint64_t)hi << 32) | lo;
 }
 
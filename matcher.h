@@ -4,7 +4,17 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <stdbool.h>
+#include "scratch.h"
+#include "pattern_table.h"
+
+#ifdef __cplusplus
+// Same size and lock-free layout as the C11 type, so C++ callers can embed
+// matcher_state_t (matcher.hpp)
+#include <atomic>
+typedef std::atomic<uint_fast64_t> atomic_uint_fast64_t;
+#else
 #include <stdatomic.h>
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -26,25 +36,96 @@ typedef struct {
     atomic_uint_fast64_t cache_misses;
     atomic_uint_fast64_t simd_operations;
     atomic_uint_fast64_t fallback_operations;
+    atomic_uint_fast64_t total_cycles;      // TSC cycles spent in search_patterns
+    atomic_uint_fast64_t invalid_utf8;      // Texts the SIMD engine found not to be UTF-8
 } perf_stats_t;
 
+// Calibrated TSC clock (computed once by timing_init)
+typedef struct {
+    uint64_t tsc_hz;                // TSC frequency in Hz
+    uint64_t ns_mult;               // Fixed-point nanoseconds per cycle
+    uint32_t ns_shift;              // Fraction bits in ns_mult
+    uint64_t base_cycles;           // TSC reading at initial calibration
+    uint64_t base_ns;               // CLOCK_MONOTONIC at initial calibration
+    bool invariant;                 // Constant rate across P/C-states
+    bool has_rdtscp;                // RDTSCP instruction available
+    bool calibrated;                // TSC usable as the timestamp source
+} tsc_clock_t;
+
+// CPU cache hierarchy in bytes (0 when a level is absent)
+typedef struct {
+    uint32_t line_size;             // Coherency line size
+    uint32_t l1d_size;              // L1 data cache per core
+    uint32_t l2_size;               // L2 cache per core
+    uint32_t llc_size;              // Last-level cache
+    uint32_t llc_sharing;           // Logical CPUs sharing the LLC
+} cache_topology_t;
+
+// Scan parameters derived from the cache topology
+typedef struct {
+    size_t scan_block_size;         // Text block kept L1-resident across all patterns
+    size_t parallel_chunk_size;     // Text span per worker when splitting a document
+} matcher_tuning_t;
+
+// Scan engines (MATCHER_ENGINE_AUTO picks per host and pattern set)
+typedef enum {
+    MATCHER_ENGINE_AUTO = 0,
+    MATCHER_ENGINE_SIMD,            // Generated AVX2/AVX-512 kernel (built-in patterns only)
+    MATCHER_ENGINE_PREFILTER,       // Pair-filter prefilter + bucket verify
+    MATCHER_ENGINE_RABIN_KARP,      // Rolling hashes by length group (AVX2)
+    MATCHER_ENGINE_WU_MANBER,       // Block-hash shift table (AVX2), long patterns
+    MATCHER_ENGINE_JIT              // Runtime-generated AVX2 kernel (opt-in, small sets)
+} matcher_engine_t;
+
+// Returned by engine kernels (uint64_t counts) when scratch memory runs
+// out; search_patterns reports it as -1
+#define MATCHER_SEARCH_FAILED UINT64_MAX
+
+struct jit_kernel;
+
 // Matcher state structure
 typedef struct {
-    void* pattern_buffer;           // Pre-compiled SIMD patterns
+    void* pattern_buffer;           // pattern_table_t block (SoA metadata + prefilter)
     size_t pattern_buffer_size;     // Buffer size in bytes
     uint32_t pattern_count;         // Number of loaded patterns
+    uint32_t max_pattern_len;       // Longest pattern (chunk overlap)
     perf_stats_t stats;             // Performance counters
+    cache_topology_t cache;         // Host cache hierarchy
+    matcher_tuning_t tuning;        // Host-specific scan parameters
+    matcher_engine_t engine;        // Requested engine (set before matcher_init)
+    matcher_engine_t active_engine; // Engine search_patterns dispatches to
+    struct jit_kernel* jit;         // Generated kernel when active_engine is JIT
+    bool whole_words;               // Only report matches on word boundaries
+    bool builtin_patterns;          // Table holds the generated legal_patterns set
     bool avx512_available;          // CPU feature detection
     bool initialized;               // Initialization status
 } matcher_state_t;
 
+static inline const pattern_table_t* matcher_pattern_table(const matcher_state_t* state) {
+    return (const pattern_table_t*)state->pattern_buffer;
+}
+
+// Resolve state->engine against host features and the pattern table
+matcher_engine_t matcher_select_engine(const matcher_state_t* state);
+const char* matcher_engine_name(matcher_engine_t engine);
+
 // Initialize the matcher with legal hearsay patterns
 int matcher_init(matcher_state_t* state);
 
+// Initialize the matcher with a custom lexicon (NUL-terminated patterns,
+// categories may be NULL). Every engine but SIMD can serve it, and AUTO
+// picks Rabin-Karp or Wu-Manber when the set suits them.
+int matcher_init_patterns(
+    matcher_state_t* state,
+    const char* const* patterns,
+    const uint32_t* categories,
+    size_t count
+);
+
 // Cleanup matcher resources
 void matcher_cleanup(matcher_state_t* state);
 
-// Main pattern search function (calls assembly SIMD core)
+// Main pattern search function (dispatches to the active engine)
 int search_patterns(
     matcher_state_t* state,
     const char* text,
@@ -53,6 +134,17 @@ int search_patterns(
     size_t max_results
 );
 
+// Pattern search with caller-owned scratch (search_patterns uses a
+// per-thread scratch created on first use)
+int search_patterns_scratch(
+    matcher_state_t* state,
+    matcher_scratch_t* scratch,
+    const char* text,
+    size_t text_len,
+    match_result_t* results,
+    size_t max_results
+);
+
 // Fast single pattern search
 int search_single_pattern(
     const char* text,
@@ -70,12 +162,20 @@ void reset_performance_stats(matcher_state_t* state);
 bool detect_avx512_support(void);
 bool detect_avx2_support(void);
 const char* get_cpu_features(void);
+int detect_cache_topology(cache_topology_t* topo);
+void derive_matcher_tuning(const cache_topology_t* topo, matcher_tuning_t* tuning);
 
-// Assembly function declarations (implemented in simd_match.s)
+// Kernels generated from patterns/legal_patterns.txt (patterns_gen.c,
+// rebuilt by `make patterns`); simd_search_patterns validates UTF-8 in the
+// same pass when utf8_valid is non-NULL; simd_search_single returns
+// UINT64_MAX when the pattern is absent
 extern uint64_t simd_search_patterns(
     const char* text,
     size_t text_len,
-    match_result_t* results
+    match_result_t* results,
+    size_t max_results,
+    bool whole_words,
+    bool* utf8_valid
 );
 
 extern uint64_t simd_search_single(
@@ -87,7 +187,9 @@ extern uint64_t simd_search_single(
 
 extern uint64_t get_pattern_count(void);
 
-// Pattern compilation and loading
+// Pattern compilation and loading (load_legal_patterns reads the
+// "<category> <phrase>" format of patterns/legal_patterns.txt into
+// matcher_init_patterns)
 int load_legal_patterns(matcher_state_t* state, const char* patterns_file);
 int compile_pattern_to_simd(const char* pattern, void* simd_buffer);
 
@@ -96,8 +198,12 @@ void* aligned_alloc_64(size_t size);
 void aligned_free(void* ptr);
 
 // Timing utilities for performance measurement
-uint64_t get_timestamp_ns(void);
-uint64_t get_cpu_cycles(void);
+int timing_init(void);                      // Calibrate TSC (idempotent)
+const tsc_clock_t* get_tsc_clock(void);
+uint64_t get_timestamp_ns(void);            // TSC-derived when calibrated, resynced every second, never decreasing
+uint64_t get_cpu_cycles(void);              // lfence; rdtsc (start of region)
+uint64_t get_cpu_cycles_end(void);          // rdtscp; lfence (end of region)
+uint64_t cycles_to_ns(uint64_t cycles);     // 0 when the TSC is not calibrated
 
 #ifdef __cplusplus
 }
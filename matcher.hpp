@@ -0,0 +1,354 @@
+#ifndef MATCHER_HPP
+#define MATCHER_HPP
+
+// Header-only C++20 front end for the matcher:
+//  - legal_nlp::matcher wraps matcher_state_t (RAII, built-in or custom
+//    patterns, span/string_view inputs, results into caller spans or
+//    std::pmr vectors)
+//  - legal_nlp::static_matcher<"he said", ...> builds an Aho-Corasick
+//    automaton for a fixed trigger list at compile time; no init cost,
+//    and search can run in constant expressions
+// Both report (offset, length, pattern_id) in offset order, then pattern
+// ID, with the engines' case folding and whole-word rule.
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "matcher.h"
+
+namespace legal_nlp {
+
+using results_t = std::pmr::vector<match_result_t>;
+
+namespace detail {
+
+constexpr std::uint8_t fold_byte(std::uint8_t c) {
+    return static_cast<std::uint8_t>(c - 'A') < 26 ? static_cast<std::uint8_t>(c | 0x20) : c;
+}
+
+constexpr bool is_word_byte(std::uint8_t c) {
+    std::uint8_t lower = c | 0x20;
+    return static_cast<std::uint8_t>(lower - 'a') < 26 || static_cast<std::uint8_t>(c - '0') < 10 || c >= 0x80;
+}
+
+constexpr std::uint8_t byte_at(std::string_view text, std::size_t i) {
+    return static_cast<std::uint8_t>(text[i]);
+}
+
+// Same rule as word_bounded() in roaring.h
+constexpr bool word_bounded(std::string_view text, std::size_t pos, std::size_t length) {
+    if (!is_word_byte(byte_at(text, pos)) || (pos > 0 && is_word_byte(byte_at(text, pos - 1)))) return false;
+    std::size_t end = pos + length;
+    return end >= text.size() || !is_word_byte(byte_at(text, end - 1)) || !is_word_byte(byte_at(text, end));
+}
+
+// Offset order, then pattern ID
+constexpr bool result_less(const match_result_t& a, const match_result_t& b) {
+    return a.offset != b.offset ? a.offset < b.offset : a.pattern_id < b.pattern_id;
+}
+
+inline std::string_view as_chars(std::span<const std::byte> bytes) {
+    return {reinterpret_cast<const char*>(bytes.data()), bytes.size()};
+}
+
+} // namespace detail
+
+// RAII owner of one matcher_state_t. Not copyable or movable (the state
+// holds atomic counters); keep it in a unique_ptr to hand it around.
+class matcher {
+public:
+    explicit matcher(matcher_engine_t engine = MATCHER_ENGINE_AUTO, bool whole_words = false) {
+        state_.engine = engine;
+        state_.whole_words = whole_words;
+        if (matcher_init(&state_) != 0) throw std::runtime_error("matcher_init failed");
+    }
+
+    // Custom lexicon of NUL-terminated patterns (matcher_init_patterns)
+    explicit matcher(std::span<const char* const> patterns, matcher_engine_t engine = MATCHER_ENGINE_AUTO,
+                     bool whole_words = false) {
+        state_.engine = engine;
+        state_.whole_words = whole_words;
+        if (matcher_init_patterns(&state_, patterns.data(), nullptr, patterns.size()) != 0) {
+            throw std::runtime_error("matcher_init_patterns failed");
+        }
+    }
+
+    ~matcher() { matcher_cleanup(&state_); }
+
+    matcher(const matcher&) = delete;
+    matcher& operator=(const matcher&) = delete;
+
+    // Zero-copy, zero-allocation: fills out and returns the match count
+    // (truncated to out.size()); throws std::runtime_error if the search
+    // fails, e.g. when scratch memory runs out
+    std::size_t search(std::string_view text, std::span<match_result_t> out) {
+        int count = search_patterns(&state_, text.data(), text.size(), out.data(), out.size());
+        if (count < 0) throw std::runtime_error("search_patterns failed");
+        return static_cast<std::size_t>(count);
+    }
+
+    std::size_t search(std::span<const std::byte> text, std::span<match_result_t> out) {
+        return search(detail::as_chars(text), out);
+    }
+
+    // Every match, reusing out's capacity; a full buffer is doubled and the
+    // text rescanned, so size the vector up front on hot paths
+    void search(std::string_view text, results_t& out) {
+        out.resize(std::max<std::size_t>(out.capacity(), 16));
+        std::size_t count;
+        while ((count = search(text, std::span<match_result_t>(out))) == out.size()) {
+            out.resize(out.size() * 2);
+        }
+        out.resize(count);
+    }
+
+    results_t search(std::string_view text,
+                     std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+        results_t out(resource);
+        search(text, out);
+        return out;
+    }
+
+    matcher_engine_t engine() const { return state_.active_engine; }
+    std::string_view engine_name() const { return matcher_engine_name(state_.active_engine); }
+    std::uint32_t pattern_count() const { return state_.pattern_count; }
+    bool whole_words() const { return state_.whole_words; }
+    void set_whole_words(bool enabled) { state_.whole_words = enabled; }
+
+    // Escape hatch for the rest of the C API (stats, tuning)
+    matcher_state_t* native() { return &state_; }
+
+private:
+    matcher_state_t state_{};
+};
+
+// String literal as a template argument: static_matcher<"he said", ...>
+template <std::size_t N>
+struct fixed_string {
+    char chars[N]{};
+
+    constexpr fixed_string(const char (&text)[N]) {
+        std::copy_n(text, N, chars);
+    }
+
+    constexpr std::string_view view() const { return {chars, N - 1}; }
+};
+
+namespace detail {
+
+// Folded bytes used by some pattern get their own class; every other byte
+// shares class 0, whose transitions all lead back to the root
+struct byte_classes_t {
+    std::array<std::uint8_t, 256> map{};
+    std::size_t count = 1;
+};
+
+template <std::size_t N>
+constexpr byte_classes_t byte_classes(const std::array<std::string_view, N>& patterns) {
+    byte_classes_t classes;
+    for (std::string_view p : patterns) {
+        for (std::size_t i = 0; i < p.size(); i++) {
+            std::uint8_t c = fold_byte(byte_at(p, i));
+            if (classes.map[c] == 0) classes.map[c] = static_cast<std::uint8_t>(classes.count++);
+        }
+    }
+    for (unsigned c = 'A'; c <= 'Z'; c++) classes.map[c] = classes.map[c | 0x20];
+    return classes;
+}
+
+template <std::size_t N>
+constexpr bool distinct_nonempty(const std::array<std::string_view, N>& patterns) {
+    for (std::size_t i = 0; i < N; i++) {
+        if (patterns[i].empty()) return false;
+        for (std::size_t j = 0; j < i; j++) {
+            bool same = patterns[i].size() == patterns[j].size();
+            for (std::size_t k = 0; same && k < patterns[i].size(); k++) {
+                same = fold_byte(byte_at(patterns[i], k)) == fold_byte(byte_at(patterns[j], k));
+            }
+            if (same) return false;
+        }
+    }
+    return true;
+}
+
+// Automaton with room for the worst case (one state per pattern byte)
+template <std::size_t MaxStates, std::size_t Classes>
+struct ac_draft {
+    std::array<std::uint32_t, MaxStates * Classes> next{};  // Full DFA after build
+    std::array<std::int32_t, MaxStates> terminal{};         // Pattern ending here, or -1
+    std::array<std::uint32_t, MaxStates> output{};          // Next terminal suffix state (0: none)
+    std::size_t state_count = 1;
+};
+
+template <std::size_t MaxStates, std::size_t Classes, std::size_t N>
+constexpr ac_draft<MaxStates, Classes> build_automaton(const std::array<std::string_view, N>& patterns,
+                                                       const byte_classes_t& classes) {
+    ac_draft<MaxStates, Classes> ac;
+    ac.terminal.fill(-1);
+
+    // Trie; 0 doubles as "no child" since nothing transitions into the root
+    for (std::size_t id = 0; id < N; id++) {
+        std::uint32_t s = 0;
+        for (std::size_t i = 0; i < patterns[id].size(); i++) {
+            std::uint32_t& child = ac.next[s * Classes + classes.map[byte_at(patterns[id], i)]];
+            if (child == 0) child = static_cast<std::uint32_t>(ac.state_count++);
+            s = child;
+        }
+        ac.terminal[s] = static_cast<std::int32_t>(id);
+    }
+
+    // Breadth-first: failure links, output links, then missing transitions
+    // borrowed from the (shallower, finished) failure state
+    std::array<std::uint32_t, MaxStates> queue{};
+    std::array<std::uint32_t, MaxStates> fail{};
+    std::size_t head = 0;
+    std::size_t tail = 0;
+    queue[tail++] = 0;
+    while (head < tail) {
+        std::uint32_t s = queue[head++];
+        for (std::size_t c = 0; c < Classes; c++) {
+            std::uint32_t& t = ac.next[s * Classes + c];
+            std::uint32_t via_fail = s == 0 ? 0 : ac.next[fail[s] * Classes + c];
+            if (t == 0) {
+                t = via_fail;
+                continue;
+            }
+            fail[t] = via_fail;
+            ac.output[t] = ac.terminal[via_fail] >= 0 ? via_fail : ac.output[via_fail];
+            queue[tail++] = t;
+        }
+    }
+    return ac;
+}
+
+} // namespace detail
+
+// Aho-Corasick over a fixed trigger list, built entirely at compile time.
+// Transitions are indexed by byte class (one per distinct folded byte in
+// the list, plus one for the rest), so the table is states x classes
+// instead of states x 256, with 16-bit states when they fit.
+template <fixed_string... Patterns>
+class static_matcher {
+public:
+    static constexpr std::size_t pattern_count = sizeof...(Patterns);
+    static constexpr std::array<std::string_view, pattern_count> patterns{Patterns.view()...};
+
+    static_assert(pattern_count > 0, "static_matcher needs at least one pattern");
+    static_assert(detail::distinct_nonempty(patterns), "patterns must be non-empty and distinct ignoring case");
+
+private:
+    static constexpr std::size_t max_states = 1 + (Patterns.view().size() + ...);
+    static constexpr detail::byte_classes_t classes = detail::byte_classes(patterns);
+    static constexpr std::size_t class_count = classes.count;
+    static constexpr auto draft = detail::build_automaton<max_states, class_count>(patterns, classes);
+
+public:
+    static constexpr std::size_t state_count = draft.state_count;
+    static constexpr std::size_t max_length = std::max({Patterns.view().size()...});
+
+private:
+    using state_t = std::conditional_t<(state_count <= 0xFFFF), std::uint16_t, std::uint32_t>;
+
+    struct tables_t {
+        std::array<std::uint8_t, 256> classes{};
+        std::array<state_t, state_count * class_count> next{};
+        std::array<std::int32_t, state_count> terminal{};
+        std::array<state_t, state_count> output{};
+        std::array<std::uint32_t, pattern_count> lengths{};
+    };
+
+    static constexpr tables_t compact() {
+        tables_t t;
+        t.classes = classes.map;
+        for (std::size_t i = 0; i < t.next.size(); i++) t.next[i] = static_cast<state_t>(draft.next[i]);
+        for (std::size_t s = 0; s < state_count; s++) {
+            t.terminal[s] = draft.terminal[s];
+            t.output[s] = static_cast<state_t>(draft.output[s]);
+        }
+        for (std::size_t id = 0; id < pattern_count; id++) {
+            t.lengths[id] = static_cast<std::uint32_t>(patterns[id].size());
+        }
+        return t;
+    }
+
+    static constexpr tables_t tables = compact();
+
+public:
+    // Fills out with the first out.size() matches in (offset, pattern ID)
+    // order and returns the count. Matches surface as they end, so once
+    // out is full it is kept as a max-heap and scanning continues until
+    // no later match can start early enough to displace one.
+    static constexpr std::size_t search(std::string_view text, std::span<match_result_t> out,
+                                        bool whole_words = false) {
+        const std::size_t capacity = out.size();
+        if (capacity == 0) return 0;
+        std::size_t count = 0;
+        state_t s = 0;
+
+        for (std::size_t i = 0; i < text.size(); i++) {
+            if (count == capacity && i + 1 >= max_length && i + 1 - max_length > out[0].offset) break;
+            s = tables.next[s * class_count + tables.classes[detail::byte_at(text, i)]];
+
+            for (state_t o = tables.terminal[s] >= 0 ? s : tables.output[s]; o != 0; o = tables.output[o]) {
+                auto id = static_cast<std::uint32_t>(tables.terminal[o]);
+                std::size_t length = tables.lengths[id];
+                std::size_t pos = i + 1 - length;
+                if (whole_words && !detail::word_bounded(text, pos, length)) continue;
+
+                match_result_t match{pos, length, id, 95};
+                if (count < capacity) {
+                    out[count++] = match;
+                    if (count == capacity) std::make_heap(out.begin(), out.end(), detail::result_less);
+                } else if (detail::result_less(match, out[0])) {
+                    std::pop_heap(out.begin(), out.end(), detail::result_less);
+                    out[capacity - 1] = match;
+                    std::push_heap(out.begin(), out.end(), detail::result_less);
+                }
+            }
+        }
+
+        std::sort(out.begin(), out.begin() + count, detail::result_less);
+        return count;
+    }
+
+    static std::size_t search(std::span<const std::byte> text, std::span<match_result_t> out,
+                              bool whole_words = false) {
+        return search(detail::as_chars(text), out, whole_words);
+    }
+
+    // Every match
+    static results_t search(std::string_view text, bool whole_words = false,
+                            std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+        results_t out(resource);
+        state_t s = 0;
+        for (std::size_t i = 0; i < text.size(); i++) {
+            s = tables.next[s * class_count + tables.classes[detail::byte_at(text, i)]];
+            for (state_t o = tables.terminal[s] >= 0 ? s : tables.output[s]; o != 0; o = tables.output[o]) {
+                auto id = static_cast<std::uint32_t>(tables.terminal[o]);
+                std::size_t length = tables.lengths[id];
+                std::size_t pos = i + 1 - length;
+                if (whole_words && !detail::word_bounded(text, pos, length)) continue;
+                out.push_back(match_result_t{pos, length, id, 95});
+            }
+        }
+        std::sort(out.begin(), out.end(), detail::result_less);
+        return out;
+    }
+
+    static constexpr bool contains(std::string_view text, bool whole_words = false) {
+        std::array<match_result_t, 1> first{};
+        return search(text, first, whole_words) != 0;
+    }
+};
+
+} // namespace legal_nlp
+
+#endif // MATCHER_HPP
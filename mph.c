@@ -0,0 +1,128 @@
+#include "mph.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+// Pilots tried per bucket before reseeding. The last singleton buckets need
+// about key_count tries each to hit the few free slots left.
+static uint64_t pilot_limit(uint32_t key_count) {
+    return (uint64_t)key_count * 16 + 1024;
+}
+
+typedef struct {
+    uint64_t* hashes;                       // Per key: mph_mix(key ^ seed)
+    uint32_t* bucket_start;                 // Counting-sort offsets, bucket_count + 1
+    uint32_t* bucket_keys;                  // Key indices grouped by bucket
+    uint32_t* order;                        // Buckets, largest first
+    uint64_t* taken;                        // Occupied slots bitmap
+    uint32_t* positions;                    // Candidate slots of the current bucket
+} mph_work_t;
+
+static void work_free(mph_work_t* w) {
+    free(w->hashes);
+    free(w->bucket_start);
+    free(w->bucket_keys);
+    free(w->order);
+    free(w->taken);
+    free(w->positions);
+}
+
+// Try one seed: returns true when every bucket found a pilot
+static bool place_buckets(const mph_params_t* params, mph_work_t* w,
+                          uint32_t* pilots, uint32_t* slots) {
+    uint32_t n = params->key_count;
+    uint32_t buckets = params->bucket_count;
+    uint32_t max_size = 0;
+
+    memset(w->bucket_start, 0, (buckets + 1) * sizeof(uint32_t));
+    for (uint32_t i = 0; i < n; i++) {
+        w->bucket_start[mph_range(w->hashes[i], buckets) + 1]++;
+    }
+    for (uint32_t b = 0; b < buckets; b++) {
+        if (w->bucket_start[b + 1] > max_size) max_size = w->bucket_start[b + 1];
+        w->bucket_start[b + 1] += w->bucket_start[b];
+    }
+    uint32_t* fill = w->order;              // Borrowed until buckets are sorted
+    memcpy(fill, w->bucket_start, buckets * sizeof(uint32_t));
+    for (uint32_t i = 0; i < n; i++) {
+        w->bucket_keys[fill[mph_range(w->hashes[i], buckets)]++] = i;
+    }
+
+    // Largest buckets first, while the table is still mostly empty
+    uint32_t filled = 0;
+    for (uint32_t size = max_size; size > 0; size--) {
+        for (uint32_t b = 0; b < buckets; b++) {
+            if (w->bucket_start[b + 1] - w->bucket_start[b] == size) w->order[filled++] = b;
+        }
+    }
+
+    memset(w->taken, 0, ((n + 63) / 64) * sizeof(uint64_t));
+    memset(pilots, 0, buckets * sizeof(uint32_t));
+    uint64_t limit = pilot_limit(n);
+
+    for (uint32_t k = 0; k < filled; k++) {
+        uint32_t b = w->order[k];
+        const uint32_t* members = &w->bucket_keys[w->bucket_start[b]];
+        uint32_t size = w->bucket_start[b + 1] - w->bucket_start[b];
+        bool placed = false;
+
+        for (uint64_t pilot = 0; pilot < limit && pilot <= UINT32_MAX && !placed; pilot++) {
+            uint64_t displacement = mph_mix(pilot + params->seed);
+            uint32_t j = 0;
+            for (; j < size; j++) {
+                uint32_t pos = mph_range(mph_mix(w->hashes[members[j]] ^ displacement), n);
+                if (w->taken[pos >> 6] & (1ULL << (pos & 63))) break;
+                // Mark now so two keys of this bucket cannot share a slot
+                w->taken[pos >> 6] |= 1ULL << (pos & 63);
+                w->positions[j] = pos;
+            }
+            if (j == size) {
+                pilots[b] = (uint32_t)pilot;
+                for (j = 0; j < size; j++) slots[members[j]] = w->positions[j];
+                placed = true;
+            } else {
+                while (j-- > 0) w->taken[w->positions[j] >> 6] &= ~(1ULL << (w->positions[j] & 63));
+            }
+        }
+        if (!placed) return false;
+    }
+    return true;
+}
+
+int mph_build(const uint64_t* keys, size_t key_count, mph_params_t* params,
+              uint32_t* pilots, uint32_t* slots) {
+    if (key_count > UINT32_MAX) return -1;
+    uint32_t n = (uint32_t)key_count;
+    params->key_count = n;
+    params->bucket_count = mph_bucket_count(n);
+    if (n == 0) {
+        params->seed = 0;
+        return 0;
+    }
+
+    mph_work_t w = {
+        .hashes = malloc(n * sizeof(uint64_t)),
+        .bucket_start = malloc((params->bucket_count + 1) * sizeof(uint32_t)),
+        .bucket_keys = malloc(n * sizeof(uint32_t)),
+        .order = malloc(params->bucket_count * sizeof(uint32_t)),
+        .taken = malloc(((n + 63) / 64) * sizeof(uint64_t)),
+        .positions = malloc(n * sizeof(uint32_t)),
+    };
+    if (!w.hashes || !w.bucket_start || !w.bucket_keys || !w.order || !w.taken || !w.positions) {
+        work_free(&w);
+        return -1;
+    }
+
+    int rc = -1;
+    for (uint64_t attempt = 0; attempt < MPH_MAX_ATTEMPTS; attempt++) {
+        params->seed = mph_mix(0x6a09e667f3bcc909ULL + attempt);
+        for (uint32_t i = 0; i < n; i++) w.hashes[i] = mph_mix(keys[i] ^ params->seed);
+        if (place_buckets(params, &w, pilots, slots)) {
+            rc = 0;
+            break;
+        }
+    }
+
+    work_free(&w);
+    return rc;
+}
@@ -0,0 +1,59 @@
+#ifndef MPH_H
+#define MPH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MPH_KEYS_PER_BUCKET  4              // Average keys sharing a pilot
+#define MPH_MAX_ATTEMPTS     16             // Seeds tried before giving up
+
+// Minimal perfect hash over distinct 64-bit keys (hash-and-displace):
+// keys hash to a bucket, each bucket stores a pilot that moves all of its
+// keys to free slots of a table with exactly one slot per key. A lookup is
+// one pilot read plus one probe; non-members map to an arbitrary slot, so
+// callers compare the stored key.
+typedef struct {
+    uint64_t seed;
+    uint32_t key_count;                     // Slots (== keys)
+    uint32_t bucket_count;                  // Pilots
+} mph_params_t;
+
+static inline uint32_t mph_bucket_count(size_t key_count) {
+    return (uint32_t)((key_count + MPH_KEYS_PER_BUCKET - 1) / MPH_KEYS_PER_BUCKET);
+}
+
+static inline uint64_t mph_mix(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+// Map a 64-bit hash onto [0, n) without a division
+static inline uint32_t mph_range(uint64_t hash, uint32_t n) {
+    return (uint32_t)(((unsigned __int128)hash * n) >> 64);
+}
+
+static inline uint32_t mph_slot(const mph_params_t* params, const uint32_t* pilots, uint64_t key) {
+    uint64_t hash = mph_mix(key ^ params->seed);
+    uint32_t pilot = pilots[mph_range(hash, params->bucket_count)];
+    return mph_range(mph_mix(hash ^ mph_mix(pilot + params->seed)), params->key_count);
+}
+
+// Build over key_count distinct keys. pilots must hold
+// mph_bucket_count(key_count) entries; slots[i] receives the slot of keys[i].
+// Returns 0, or -1 if no seed worked (duplicate keys) or memory ran out.
+int mph_build(const uint64_t* keys, size_t key_count, mph_params_t* params,
+              uint32_t* pilots, uint32_t* slots);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MPH_H
@@ -0,0 +1,265 @@
+#include "pattern_table.h"
+#include "matcher.h"
+#include <stdlib.h>
+#include <string.h>
+
+static uint32_t align_up(uint32_t offset, uint32_t alignment) {
+    return (offset + alignment - 1) & ~(alignment - 1);
+}
+
+uint32_t pattern_fingerprint(const uint8_t* folded, size_t len) {
+    uint32_t hash = 0;
+    for (size_t i = 0; i < len; i++) {
+        hash = hash * FINGERPRINT_BASE + folded[i];
+    }
+    return hash;
+}
+
+// Pair filter and first-byte buckets for the two-stage prefilter
+static void build_prefilter(pattern_table_t* table) {
+    uint64_t* filter = (uint64_t*)pt_pair_filter(table);
+    uint32_t* buckets = (uint32_t*)pt_buckets(table);
+    uint32_t* ids = (uint32_t*)pt_bucket_ids(table);
+    const uint8_t* first_bytes = pt_first_bytes(table);
+    const uint16_t* lengths = pt_lengths(table);
+
+    for (uint32_t i = 0; i < table->count; i++) {
+        const uint8_t* pattern = pt_pattern(table, i);
+        buckets[first_bytes[i] + 1]++;
+
+        // Single-byte patterns accept any following byte
+        for (unsigned second = 0; second < 256; second++) {
+            if (lengths[i] > 1 && second != pattern[1]) continue;
+            unsigned pair = (unsigned)first_bytes[i] << 8 | second;
+            filter[pair >> 6] |= 1ULL << (pair & 63);
+        }
+    }
+
+    // Prefix sums give each first byte a contiguous run of pattern IDs
+    for (int b = 0; b < 256; b++) buckets[b + 1] += buckets[b];
+    uint32_t fill[256];
+    memcpy(fill, buckets, sizeof(fill));
+    for (uint32_t i = 0; i < table->count; i++) {
+        ids[fill[first_bytes[i]]++] = i;
+    }
+}
+
+typedef struct {
+    uint64_t key;
+    uint32_t id;
+} keyed_id_t;
+
+static int compare_keyed_ids(const void* a, const void* b) {
+    const keyed_id_t* x = a;
+    const keyed_id_t* y = b;
+    if (x->key != y->key) return x->key < y->key ? -1 : 1;
+    return x->id < y->id ? -1 : (x->id > y->id);
+}
+
+// Minimal perfect hash from (length, fingerprint) keys to hash entries
+static int build_fingerprint_hash(pattern_table_t* table) {
+    uint32_t n = table->count;
+    const uint16_t* lengths = pt_lengths(table);
+    const uint32_t* fingerprints = pt_fingerprints(table);
+    keyed_id_t* sorted = malloc((n ? n : 1) * sizeof(keyed_id_t));
+    uint64_t* keys = malloc((n ? n : 1) * sizeof(uint64_t));
+    uint32_t* slots = malloc((n ? n : 1) * sizeof(uint32_t));
+    if (!sorted || !keys || !slots) {
+        free(sorted);
+        free(keys);
+        free(slots);
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < n; i++) {
+        sorted[i].key = pattern_key(lengths[i], fingerprints[i]);
+        sorted[i].id = i;
+    }
+    qsort(sorted, n, sizeof(keyed_id_t), compare_keyed_ids);
+
+    uint32_t* hash_ids = (uint32_t*)pt_hash_ids(table);
+    uint32_t distinct = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        hash_ids[i] = sorted[i].id;
+        if (i == 0 || sorted[i].key != sorted[i - 1].key) keys[distinct++] = sorted[i].key;
+    }
+
+    int rc = mph_build(keys, distinct, &table->mph, (uint32_t*)pt_pilots(table), slots);
+    if (rc == 0) {
+        pattern_hash_entry_t* entries = (pattern_hash_entry_t*)pt_hash_entries(table);
+        uint32_t run = 0;
+        for (uint32_t k = 0; k < distinct; k++) {
+            uint32_t start = run;
+            while (run < n && sorted[run].key == keys[k]) run++;
+            pattern_hash_entry_t* entry = &entries[slots[k]];
+            entry->key = keys[k];
+            entry->count = run - start;
+            entry->id = entry->count == 1 ? sorted[start].id : start;
+        }
+    }
+
+    free(sorted);
+    free(keys);
+    free(slots);
+    return rc;
+}
+
+// Distinct lengths (rolling-hash groups) and the fingerprint filter
+static void build_fingerprint_filter(pattern_table_t* table) {
+    const uint16_t* lengths = pt_lengths(table);
+    const uint32_t* fingerprints = pt_fingerprints(table);
+    uint32_t* groups = (uint32_t*)pt_length_groups(table);
+    uint64_t* filter = (uint64_t*)pt_fp_filter(table);
+
+    uint64_t seen[65536 / 64] = {0};
+    for (uint32_t i = 0; i < table->count; i++) {
+        seen[lengths[i] >> 6] |= 1ULL << (lengths[i] & 63);
+    }
+    for (uint32_t len = table->min_len; len <= table->max_len && table->count; len++) {
+        if (seen[len >> 6] & (1ULL << (len & 63))) groups[table->length_group_count++] = len;
+    }
+
+    for (uint32_t i = 0; i < table->count; i++) {
+        uint32_t bit = pt_fp_filter_index(lengths[i], fingerprints[i], table->fp_filter_log2);
+        filter[bit >> 6] |= 1ULL << (bit & 63);
+    }
+}
+
+// Wu-Manber shift table over the first wm_window folded bytes of every
+// pattern, plus IDs bucketed by the hash of the block ending that window
+static void build_wu_manber(pattern_table_t* table) {
+    if (table->wm_block == 0) return;
+    uint32_t block = table->wm_block;
+    uint32_t window = table->wm_window;
+    uint32_t size = 1u << table->wm_hash_bits;
+    uint8_t* shift = (uint8_t*)pt_wm_shift(table);
+    uint32_t* buckets = (uint32_t*)pt_wm_buckets(table);
+    uint32_t* ids = (uint32_t*)pt_wm_ids(table);
+
+    memset(shift, (int)(window - block + 1), size);
+    for (uint32_t i = 0; i < table->count; i++) {
+        const uint8_t* pattern = pt_pattern(table, i);
+        // A block ending at q lets the window advance window - 1 - q bytes
+        for (uint32_t q = block - 1; q < window; q++) {
+            uint32_t hash = wm_block_hash(pattern + q + 1 - block, block, table->wm_hash_bits);
+            uint32_t distance = window - 1 - q;
+            if (distance < shift[hash]) shift[hash] = (uint8_t)distance;
+        }
+        buckets[wm_block_hash(pattern + window - block, block, table->wm_hash_bits) + 1]++;
+    }
+
+    for (uint32_t h = 0; h < size; h++) buckets[h + 1] += buckets[h];
+    uint32_t* fill = malloc(size * sizeof(uint32_t));
+    if (!fill) {
+        table->wm_block = 0;
+        return;
+    }
+    memcpy(fill, buckets, size * sizeof(uint32_t));
+    for (uint32_t i = 0; i < table->count; i++) {
+        const uint8_t* pattern = pt_pattern(table, i);
+        ids[fill[wm_block_hash(pattern + window - block, block, table->wm_hash_bits)]++] = i;
+    }
+    free(fill);
+}
+
+// ~16 filter bits per pattern keeps false positives near 1/16
+static uint32_t fp_filter_log2(uint32_t count) {
+    uint32_t log2 = FP_FILTER_MIN_LOG2;
+    while (log2 < FP_FILTER_MAX_LOG2 && (1ULL << log2) < (uint64_t)count * 16) log2++;
+    return log2;
+}
+
+pattern_table_t* pattern_table_build(const char* const* patterns, const uint32_t* categories, size_t count) {
+    uint32_t pool_size = 0;
+    size_t min_len = SIZE_MAX;
+    for (size_t i = 0; i < count; i++) {
+        size_t len = strlen(patterns[i]);
+        if (len == 0 || len > UINT16_MAX) return NULL;
+        pool_size += (uint32_t)len;
+        if (len < min_len) min_len = len;
+    }
+
+    // Bigger sets use 3-byte blocks and a wider hash to keep shifts long
+    uint32_t wm_block = 0, wm_hash_bits = 0;
+    if (count && min_len >= 2) {
+        bool wide = count >= WM_BLOCK3_MIN_PATTERNS && min_len >= 3;
+        wm_block = wide ? 3 : 2;
+        wm_hash_bits = wide ? 15 : 12;
+    }
+    uint32_t wm_size = wm_block ? 1u << wm_hash_bits : 0;
+
+    // Lay out each array on its own cache line boundary
+    uint32_t n = (uint32_t)count;
+    uint32_t filter_log2 = fp_filter_log2(n);
+    uint32_t offset = align_up(sizeof(pattern_table_t), 64);
+    pattern_table_t layout = {0};
+    layout.lengths_off = offset;        offset = align_up(offset + n * sizeof(uint16_t), 64);
+    layout.first_bytes_off = offset;    offset = align_up(offset + n, 64);
+    layout.last_bytes_off = offset;     offset = align_up(offset + n, 64);
+    layout.fingerprints_off = offset;   offset = align_up(offset + n * sizeof(uint32_t), 64);
+    layout.categories_off = offset;     offset = align_up(offset + n * sizeof(uint32_t), 64);
+    layout.string_offsets_off = offset; offset = align_up(offset + (n + 1) * sizeof(uint32_t), 64);
+    layout.pool_off = offset;           offset = align_up(offset + pool_size, 64);
+    layout.pair_filter_off = offset;    offset = align_up(offset + PAIR_FILTER_BYTES, 64);
+    layout.buckets_off = offset;        offset = align_up(offset + 257 * sizeof(uint32_t), 64);
+    layout.bucket_ids_off = offset;     offset = align_up(offset + n * sizeof(uint32_t), 64);
+    layout.pilots_off = offset;         offset = align_up(offset + mph_bucket_count(n) * sizeof(uint32_t), 64);
+    layout.hash_entries_off = offset;   offset = align_up(offset + n * sizeof(pattern_hash_entry_t), 64);
+    layout.hash_ids_off = offset;       offset = align_up(offset + n * sizeof(uint32_t), 64);
+    layout.length_groups_off = offset;  offset = align_up(offset + n * sizeof(uint32_t), 64);
+    layout.fp_filter_off = offset;      offset = align_up(offset + (1u << filter_log2) / 8, 64);
+    layout.wm_shift_off = offset;       offset = align_up(offset + wm_size + 4, 64);
+    layout.wm_buckets_off = offset;     offset = align_up(offset + (wm_size + 1) * sizeof(uint32_t), 64);
+    layout.wm_ids_off = offset;         offset = align_up(offset + n * sizeof(uint32_t), 64);
+
+    pattern_table_t* table = aligned_alloc_64(offset);
+    if (!table) return NULL;
+    memset(table, 0, offset);
+    *table = layout;
+    table->count = n;
+    table->pool_size = pool_size;
+    table->total_size = offset;
+    table->fp_filter_log2 = filter_log2;
+    table->wm_block = wm_block;
+    table->wm_hash_bits = wm_hash_bits;
+    table->wm_window = wm_block ? (uint32_t)(min_len < WM_MAX_WINDOW ? min_len : WM_MAX_WINDOW) : 0;
+    table->min_len = count ? UINT32_MAX : 0;
+
+    uint16_t* lengths = (uint16_t*)pt_lengths(table);
+    uint8_t* first_bytes = (uint8_t*)pt_first_bytes(table);
+    uint8_t* last_bytes = (uint8_t*)pt_last_bytes(table);
+    uint32_t* fingerprints = (uint32_t*)pt_fingerprints(table);
+    uint32_t* category_masks = (uint32_t*)pt_categories(table);
+    uint32_t* string_offsets = (uint32_t*)pt_string_offsets(table);
+    uint8_t* pool = (uint8_t*)pt_pool(table);
+
+    uint32_t cursor = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t len = (uint32_t)strlen(patterns[i]);
+        uint8_t* folded = pool + cursor;
+        for (uint32_t k = 0; k < len; k++) {
+            folded[k] = fold_byte((uint8_t)patterns[i][k]);
+        }
+
+        string_offsets[i] = cursor;
+        lengths[i] = (uint16_t)len;
+        first_bytes[i] = folded[0];
+        last_bytes[i] = folded[len - 1];
+        fingerprints[i] = pattern_fingerprint(folded, len);
+        category_masks[i] = categories ? categories[i] : 0;
+        cursor += len;
+
+        if (len < table->min_len) table->min_len = len;
+        if (len > table->max_len) table->max_len = len;
+    }
+    string_offsets[n] = cursor;
+
+    build_prefilter(table);
+    build_fingerprint_filter(table);
+    build_wu_manber(table);
+    if (build_fingerprint_hash(table) != 0) {
+        aligned_free(table);
+        return NULL;
+    }
+    return table;
+}
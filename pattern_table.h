@@ -0,0 +1,159 @@
+#ifndef PATTERN_TABLE_H
+#define PATTERN_TABLE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "mph.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Hearsay categories (bits of a pattern's category mask)
+#define PATTERN_CAT_ATTRIBUTION  (1u << 0)  // "he said", "as stated by"
+#define PATTERN_CAT_SECONDHAND   (1u << 1)  // "i heard", "according to"
+#define PATTERN_CAT_REPORTED     (1u << 2)  // "reportedly", "allegedly"
+#define PATTERN_CAT_IMPEACHMENT  (1u << 3)  // "didn't you say"
+
+#define PAIR_FILTER_BYTES        (65536 / 8)
+#define FINGERPRINT_BASE         0x01000193u
+#define FP_FILTER_MIN_LOG2       12         // 512-byte fingerprint filter floor
+#define FP_FILTER_MAX_LOG2       28         // 32MB ceiling
+#define WM_BLOCK3_MIN_PATTERNS   1024       // Larger sets hash 3-byte blocks
+#define WM_MAX_WINDOW            256        // Shifts must fit a uint8_t
+
+// Fingerprint lookup slot. Patterns whose (length, fingerprint) keys
+// collide share one slot and list their IDs in the hash ID array.
+typedef struct {
+    uint64_t key;                   // pattern_key(length, fingerprint)
+    uint32_t id;                    // Pattern ID, or first hash ID index when count > 1
+    uint32_t count;                 // Patterns with this key
+} pattern_hash_entry_t;
+
+// Structure-of-arrays pattern table. The header is followed by contiguous
+// per-field arrays and one packed pool of case-folded pattern bytes, all in
+// a single 64-byte aligned block addressed by offsets, so copying the block
+// (e.g. to a NUMA replica) relocates the whole table.
+typedef struct {
+    uint32_t count;                 // Patterns
+    uint32_t min_len;               // Shortest pattern
+    uint32_t max_len;               // Longest pattern
+    uint32_t pool_size;             // Bytes in the string pool
+    uint64_t total_size;            // Block size including this header
+    uint32_t lengths_off;           // uint16_t[count]
+    uint32_t first_bytes_off;       // uint8_t[count], folded
+    uint32_t last_bytes_off;        // uint8_t[count], folded
+    uint32_t fingerprints_off;      // uint32_t[count], pattern_fingerprint()
+    uint32_t categories_off;        // uint32_t[count], PATTERN_CAT_* masks
+    uint32_t string_offsets_off;    // uint32_t[count + 1] into the pool
+    uint32_t pool_off;              // uint8_t[pool_size]
+    uint32_t pair_filter_off;       // uint64_t[1024]: folded (first, second) pairs
+    uint32_t buckets_off;           // uint32_t[257]: ID ranges by first byte
+    uint32_t bucket_ids_off;        // uint32_t[count]: IDs grouped by first byte
+    uint32_t pilots_off;            // uint32_t[mph.bucket_count]
+    uint32_t hash_entries_off;      // pattern_hash_entry_t[mph.key_count], MPH slot order
+    uint32_t hash_ids_off;          // uint32_t[count]: IDs sorted by key
+    uint32_t length_groups_off;     // uint32_t[length_group_count]: distinct lengths, ascending
+    uint32_t length_group_count;
+    uint32_t fp_filter_off;         // uint64_t[]: one bit per pt_fp_filter_index()
+    uint32_t fp_filter_log2;        // Filter bits = 1 << fp_filter_log2
+    uint32_t wm_block;              // Wu-Manber block bytes (2 or 3; 0 = min_len too short)
+    uint32_t wm_window;             // Pattern prefix bytes the shifts cover
+    uint32_t wm_hash_bits;          // Block hash bits
+    uint32_t wm_shift_off;          // uint8_t[1 << wm_hash_bits] + 4 bytes of gather padding
+    uint32_t wm_buckets_off;        // uint32_t[(1 << wm_hash_bits) + 1]: IDs by last-block hash
+    uint32_t wm_ids_off;            // uint32_t[count]
+    mph_params_t mph;               // Minimal perfect hash over distinct keys
+} pattern_table_t;
+
+#define PT_FIELD(table, type, field) ((const type*)((const char*)(table) + (table)->field))
+
+static inline const uint16_t* pt_lengths(const pattern_table_t* t) { return PT_FIELD(t, uint16_t, lengths_off); }
+static inline const uint8_t* pt_first_bytes(const pattern_table_t* t) { return PT_FIELD(t, uint8_t, first_bytes_off); }
+static inline const uint8_t* pt_last_bytes(const pattern_table_t* t) { return PT_FIELD(t, uint8_t, last_bytes_off); }
+static inline const uint32_t* pt_fingerprints(const pattern_table_t* t) { return PT_FIELD(t, uint32_t, fingerprints_off); }
+static inline const uint32_t* pt_categories(const pattern_table_t* t) { return PT_FIELD(t, uint32_t, categories_off); }
+static inline const uint32_t* pt_string_offsets(const pattern_table_t* t) { return PT_FIELD(t, uint32_t, string_offsets_off); }
+static inline const uint8_t* pt_pool(const pattern_table_t* t) { return PT_FIELD(t, uint8_t, pool_off); }
+static inline const uint64_t* pt_pair_filter(const pattern_table_t* t) { return PT_FIELD(t, uint64_t, pair_filter_off); }
+static inline const uint32_t* pt_buckets(const pattern_table_t* t) { return PT_FIELD(t, uint32_t, buckets_off); }
+static inline const uint32_t* pt_bucket_ids(const pattern_table_t* t) { return PT_FIELD(t, uint32_t, bucket_ids_off); }
+static inline const uint32_t* pt_pilots(const pattern_table_t* t) { return PT_FIELD(t, uint32_t, pilots_off); }
+static inline const pattern_hash_entry_t* pt_hash_entries(const pattern_table_t* t) { return PT_FIELD(t, pattern_hash_entry_t, hash_entries_off); }
+static inline const uint32_t* pt_hash_ids(const pattern_table_t* t) { return PT_FIELD(t, uint32_t, hash_ids_off); }
+static inline const uint32_t* pt_length_groups(const pattern_table_t* t) { return PT_FIELD(t, uint32_t, length_groups_off); }
+static inline const uint64_t* pt_fp_filter(const pattern_table_t* t) { return PT_FIELD(t, uint64_t, fp_filter_off); }
+static inline const uint8_t* pt_wm_shift(const pattern_table_t* t) { return PT_FIELD(t, uint8_t, wm_shift_off); }
+static inline const uint32_t* pt_wm_buckets(const pattern_table_t* t) { return PT_FIELD(t, uint32_t, wm_buckets_off); }
+static inline const uint32_t* pt_wm_ids(const pattern_table_t* t) { return PT_FIELD(t, uint32_t, wm_ids_off); }
+
+// Folded bytes of one pattern (not NUL-terminated)
+static inline const uint8_t* pt_pattern(const pattern_table_t* t, uint32_t id) {
+    return pt_pool(t) + pt_string_offsets(t)[id];
+}
+
+// ASCII case fold used for patterns and text alike
+static inline uint8_t fold_byte(uint8_t c) {
+    return (uint8_t)(c - 'A') < 26 ? c | 0x20 : c;
+}
+
+// Compare text against folded pattern bytes
+static inline bool folded_equal(const uint8_t* text, const uint8_t* folded, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        if (fold_byte(text[i]) != folded[i]) return false;
+    }
+    return true;
+}
+
+// Wu-Manber hash of block folded bytes: 5 bits of shift per byte
+static inline uint32_t wm_block_hash(const uint8_t* folded, uint32_t block, uint32_t bits) {
+    uint32_t hash = 0;
+    for (uint32_t i = 0; i < block; i++) hash = (hash << 5) ^ folded[i];
+    return hash & ((1u << bits) - 1);
+}
+
+// Polynomial hash (base FINGERPRINT_BASE, mod 2^32) of folded bytes; the
+// same function a rolling hash computes over a text window
+uint32_t pattern_fingerprint(const uint8_t* folded, size_t len);
+
+static inline uint64_t pattern_key(uint32_t length, uint32_t fingerprint) {
+    return (uint64_t)length << 32 | fingerprint;
+}
+
+// Length salt mixed into filter indices so equal fingerprints of different
+// window lengths land on different bits
+static inline uint32_t fp_length_salt(uint32_t length) {
+    return length * 0x85ebca6bu;
+}
+
+// Fingerprint filter bit for a (length, fingerprint) pair. Multiplying
+// moves the well-mixed high bits of the product into the index.
+static inline uint32_t pt_fp_filter_index(uint32_t length, uint32_t fingerprint, uint32_t log2) {
+    return ((fingerprint ^ fp_length_salt(length)) * 0x9e3779b1u) >> (32 - log2);
+}
+
+// Patterns with this length and fingerprint, or NULL: one pilot read and
+// one probe. A hit is a candidate only; the bytes still need comparing.
+static inline const pattern_hash_entry_t* pt_lookup(const pattern_table_t* t,
+                                                    uint32_t length, uint32_t fingerprint) {
+    if (t->mph.key_count == 0) return NULL;
+    uint64_t key = pattern_key(length, fingerprint);
+    const pattern_hash_entry_t* entry = &pt_hash_entries(t)[mph_slot(&t->mph, pt_pilots(t), key)];
+    return entry->key == key ? entry : NULL;
+}
+
+// IDs behind a lookup hit (count of them in entry->count)
+static inline const uint32_t* pt_entry_ids(const pattern_table_t* t, const pattern_hash_entry_t* entry) {
+    return entry->count == 1 ? &entry->id : pt_hash_ids(t) + entry->id;
+}
+
+// Build a table in one aligned_alloc_64 block (free with aligned_free).
+// categories may be NULL. Empty patterns are rejected.
+pattern_table_t* pattern_table_build(const char* const* patterns, const uint32_t* categories, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PATTERN_TABLE_H
@@ -0,0 +1,382 @@
+// Code generated by patterns/generate.go from patterns/legal_patterns.txt; DO NOT EDIT.
+
+#include "matcher.h"
+#include "roaring.h"
+#include "patterns_gen.h"
+#include <string.h>
+#include <immintrin.h>
+
+const legal_pattern_t legal_patterns[LEGAL_PATTERN_COUNT] = {
+    { "he said", PATTERN_CAT_ATTRIBUTION },
+    { "she said", PATTERN_CAT_ATTRIBUTION },
+    { "she told", PATTERN_CAT_ATTRIBUTION },
+    { "he told", PATTERN_CAT_ATTRIBUTION },
+    { "i heard", PATTERN_CAT_SECONDHAND },
+    { "according to", PATTERN_CAT_SECONDHAND },
+    { "reportedly", PATTERN_CAT_REPORTED },
+    { "allegedly", PATTERN_CAT_REPORTED },
+    { "it was reported", PATTERN_CAT_REPORTED },
+    { "sources say", PATTERN_CAT_SECONDHAND },
+    { "witnesses claim", PATTERN_CAT_SECONDHAND },
+    { "testimony indicates", PATTERN_CAT_SECONDHAND },
+    { "didn't you say", PATTERN_CAT_IMPEACHMENT },
+    { "you mentioned", PATTERN_CAT_IMPEACHMENT },
+    { "as stated by", PATTERN_CAT_ATTRIBUTION },
+};
+
+// Folded pattern bytes for verification
+static const char* const kernel_patterns[LEGAL_PATTERN_COUNT] = {
+    "he said",
+    "she said",
+    "she told",
+    "he told",
+    "i heard",
+    "according to",
+    "reportedly",
+    "allegedly",
+    "it was reported",
+    "sources say",
+    "witnesses claim",
+    "testimony indicates",
+    "didn't you say",
+    "you mentioned",
+    "as stated by",
+};
+
+static const uint32_t kernel_lengths[LEGAL_PATTERN_COUNT] = {
+    7,
+    8,
+    8,
+    7,
+    7,
+    12,
+    10,
+    9,
+    15,
+    11,
+    15,
+    19,
+    14,
+    13,
+    12,
+};
+
+#if defined(__AVX512BW__)
+#define KERNEL_LANES 64
+typedef __m512i kernel_vec_t;
+typedef uint64_t kernel_mask_t;
+
+static inline kernel_vec_t load_folded(const uint8_t* p) {
+    __m512i bytes = _mm512_loadu_si512(p);
+    __mmask64 upper = _mm512_cmplt_epu8_mask(_mm512_sub_epi8(bytes, _mm512_set1_epi8('A')), _mm512_set1_epi8(26));
+    return _mm512_mask_add_epi8(bytes, upper, bytes, _mm512_set1_epi8(0x20));
+}
+
+static inline kernel_mask_t match_byte(kernel_vec_t v, uint8_t c) {
+    return _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8((char)c));
+}
+
+static inline kernel_vec_t load_raw(const uint8_t* p) {
+    return _mm512_loadu_si512(p);
+}
+
+// table indexed by the high (shift 4) or low (shift 0) nibble of each byte
+static inline kernel_vec_t lookup_nibble(kernel_vec_t v, int shift, __m128i table) {
+    __m512i nibbles = _mm512_and_si512(_mm512_srli_epi16(v, shift), _mm512_set1_epi8(0x0F));
+    return _mm512_shuffle_epi8(_mm512_broadcast_i32x4(table), nibbles);
+}
+
+static inline kernel_vec_t vec_and(kernel_vec_t a, kernel_vec_t b) { return _mm512_and_si512(a, b); }
+static inline kernel_vec_t vec_or(kernel_vec_t a, kernel_vec_t b) { return _mm512_or_si512(a, b); }
+static inline kernel_vec_t vec_xor(kernel_vec_t a, kernel_vec_t b) { return _mm512_xor_si512(a, b); }
+static inline kernel_vec_t vec_subs(kernel_vec_t v, uint8_t c) { return _mm512_subs_epu8(v, _mm512_set1_epi8((char)c)); }
+static inline kernel_vec_t vec_set1(uint8_t c) { return _mm512_set1_epi8((char)c); }
+static inline kernel_vec_t vec_zero(void) { return _mm512_setzero_si512(); }
+static inline bool vec_any(kernel_vec_t v) { return _mm512_test_epi8_mask(v, v) != 0; }
+
+// Lanes below limit: (v - base) < limit unsigned
+static inline kernel_mask_t in_range(kernel_vec_t v, uint8_t base, uint8_t limit) {
+    return _mm512_cmplt_epu8_mask(_mm512_sub_epi8(v, _mm512_set1_epi8((char)base)), _mm512_set1_epi8((char)limit));
+}
+
+static inline kernel_mask_t high_bit(kernel_vec_t v) {
+    return _mm512_movepi8_mask(v);
+}
+#else
+#define KERNEL_LANES 32
+typedef __m256i kernel_vec_t;
+typedef uint32_t kernel_mask_t;
+
+static inline kernel_vec_t load_folded(const uint8_t* p) {
+    __m256i bytes = _mm256_loadu_si256((const __m256i*)p);
+    __m256i offset = _mm256_sub_epi8(bytes, _mm256_set1_epi8('A'));
+    __m256i upper = _mm256_cmpeq_epi8(_mm256_min_epu8(offset, _mm256_set1_epi8(25)), offset);
+    return _mm256_or_si256(bytes, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+}
+
+static inline kernel_mask_t match_byte(kernel_vec_t v, uint8_t c) {
+    return (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8((char)c)));
+}
+
+static inline kernel_vec_t load_raw(const uint8_t* p) {
+    return _mm256_loadu_si256((const __m256i*)p);
+}
+
+// table indexed by the high (shift 4) or low (shift 0) nibble of each byte
+static inline kernel_vec_t lookup_nibble(kernel_vec_t v, int shift, __m128i table) {
+    __m256i nibbles = _mm256_and_si256(_mm256_srli_epi16(v, shift), _mm256_set1_epi8(0x0F));
+    return _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(table), nibbles);
+}
+
+static inline kernel_vec_t vec_and(kernel_vec_t a, kernel_vec_t b) { return _mm256_and_si256(a, b); }
+static inline kernel_vec_t vec_or(kernel_vec_t a, kernel_vec_t b) { return _mm256_or_si256(a, b); }
+static inline kernel_vec_t vec_xor(kernel_vec_t a, kernel_vec_t b) { return _mm256_xor_si256(a, b); }
+static inline kernel_vec_t vec_subs(kernel_vec_t v, uint8_t c) { return _mm256_subs_epu8(v, _mm256_set1_epi8((char)c)); }
+static inline kernel_vec_t vec_set1(uint8_t c) { return _mm256_set1_epi8((char)c); }
+static inline kernel_vec_t vec_zero(void) { return _mm256_setzero_si256(); }
+static inline bool vec_any(kernel_vec_t v) { return !_mm256_testz_si256(v, v); }
+
+// Lanes below limit: (v - base) < limit unsigned
+static inline kernel_mask_t in_range(kernel_vec_t v, uint8_t base, uint8_t limit) {
+    __m256i offset = _mm256_sub_epi8(v, _mm256_set1_epi8((char)base));
+    __m256i below = _mm256_cmpeq_epi8(_mm256_min_epu8(offset, _mm256_set1_epi8((char)(limit - 1))), offset);
+    return (uint32_t)_mm256_movemask_epi8(below);
+}
+
+static inline kernel_mask_t high_bit(kernel_vec_t v) {
+    return (uint32_t)_mm256_movemask_epi8(v);
+}
+#endif
+
+// UTF-8 validation (Keep's lookup algorithm, as in simdjson): three nibble
+// lookups classify each byte pair, and saturating subtractions find the
+// lanes that must continue a 3/4-byte sequence. Case folding only touches
+// ASCII letters, which classify the same either way, so the folded block
+// can be validated directly. Nonzero lanes are errors.
+#define UTF8_TOO_SHORT  (1 << 0)
+#define UTF8_TOO_LONG   (1 << 1)
+#define UTF8_OVERLONG_3 (1 << 2)
+#define UTF8_TOO_LARGE  (1 << 3)
+#define UTF8_SURROGATE  (1 << 4)
+#define UTF8_OVERLONG_2 (1 << 5)
+#define UTF8_TOO_LARGE_1000 (1 << 6)
+#define UTF8_OVERLONG_4 (1 << 6)
+#define UTF8_TWO_CONTS  (1 << 7)
+#define UTF8_CARRY (UTF8_TOO_SHORT | UTF8_TOO_LONG | UTF8_TWO_CONTS)
+
+static inline kernel_vec_t utf8_errors(kernel_vec_t cur, kernel_vec_t prev1, kernel_vec_t prev2, kernel_vec_t prev3) {
+    const __m128i byte_1_high = _mm_setr_epi8(
+        UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+        UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+        UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS,
+        UTF8_TOO_SHORT | UTF8_OVERLONG_2,
+        UTF8_TOO_SHORT,
+        UTF8_TOO_SHORT | UTF8_OVERLONG_3 | UTF8_SURROGATE,
+        UTF8_TOO_SHORT | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4);
+    const __m128i byte_1_low = _mm_setr_epi8(
+        UTF8_CARRY | UTF8_OVERLONG_3 | UTF8_OVERLONG_2 | UTF8_OVERLONG_4,
+        UTF8_CARRY | UTF8_OVERLONG_2,
+        UTF8_CARRY,
+        UTF8_CARRY,
+        UTF8_CARRY | UTF8_TOO_LARGE,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_SURROGATE,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000);
+    const __m128i byte_2_high = _mm_setr_epi8(
+        UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+        UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4,
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE,
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+        UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT);
+
+    kernel_vec_t special = vec_and(vec_and(lookup_nibble(prev1, 4, byte_1_high),
+                                           lookup_nibble(prev1, 0, byte_1_low)),
+                                   lookup_nibble(cur, 4, byte_2_high));
+    // Top bit set where prev2 is a 3/4-byte lead (>= 0xE0) or prev3 a 4-byte one
+    kernel_vec_t must_continue = vec_or(vec_subs(prev2, 0xE0 - 0x80), vec_subs(prev3, 0xF0 - 0x80));
+    return vec_xor(vec_and(must_continue, vec_set1(0x80)), special);
+}
+
+// is_word_byte per lane: letters, digits and any byte of a multi-byte rune
+static inline kernel_mask_t word_bytes(kernel_vec_t v) {
+    return in_range(vec_or(v, vec_set1(0x20)), 'a', 26) | in_range(v, '0', 10) | high_bit(v);
+}
+
+// Whether the text ends inside a multi-byte sequence
+static inline bool utf8_truncated(const uint8_t* bytes, size_t len) {
+    for (size_t back = 1; back <= 3 && back <= len; back++) {
+        uint8_t c = bytes[len - back];
+        if (c < 0x80) return false;
+        if (c >= 0xC0) return back < (c >= 0xF0 ? 4u : c >= 0xE0 ? 3u : 2u);
+    }
+    return false;
+}
+
+// Bytes one block reads: every pattern may start at any of its lanes, and
+// validation looks back at the 3 bytes before the block
+#define KERNEL_WINDOW (KERNEL_LANES + LEGAL_PATTERN_MAX_LEN - 1)
+#define KERNEL_LOOKBACK 3
+
+// Per-pattern candidate masks for the KERNEL_LANES positions at p; at0 is
+// the folded block itself, shared with validation and word classification
+static inline void block_candidates(const uint8_t* p, kernel_vec_t at0, kernel_mask_t* m) {
+    kernel_vec_t at1 = load_folded(p + 1);
+    kernel_vec_t at6 = load_folded(p + 6);
+    kernel_vec_t at7 = load_folded(p + 7);
+    kernel_vec_t at8 = load_folded(p + 8);
+    kernel_vec_t at9 = load_folded(p + 9);
+    kernel_vec_t at10 = load_folded(p + 10);
+    kernel_vec_t at11 = load_folded(p + 11);
+    kernel_vec_t at12 = load_folded(p + 12);
+    kernel_vec_t at13 = load_folded(p + 13);
+    kernel_vec_t at14 = load_folded(p + 14);
+    kernel_vec_t at18 = load_folded(p + 18);
+
+    m[0] = match_byte(at0, 0x68) & match_byte(at1, 0x65) & match_byte(at6, 0x64);   // he said
+    m[1] = match_byte(at0, 0x73) & match_byte(at1, 0x68) & match_byte(at7, 0x64);   // she said
+    m[2] = match_byte(at0, 0x73) & match_byte(at1, 0x68) & match_byte(at7, 0x64);   // she told
+    m[3] = match_byte(at0, 0x68) & match_byte(at1, 0x65) & match_byte(at6, 0x64);   // he told
+    m[4] = match_byte(at0, 0x69) & match_byte(at1, 0x20) & match_byte(at6, 0x64);   // i heard
+    m[5] = match_byte(at0, 0x61) & match_byte(at1, 0x63) & match_byte(at11, 0x6f);   // according to
+    m[6] = match_byte(at0, 0x72) & match_byte(at1, 0x65) & match_byte(at9, 0x79);   // reportedly
+    m[7] = match_byte(at0, 0x61) & match_byte(at1, 0x6c) & match_byte(at8, 0x79);   // allegedly
+    m[8] = match_byte(at0, 0x69) & match_byte(at1, 0x74) & match_byte(at14, 0x64);   // it was reported
+    m[9] = match_byte(at0, 0x73) & match_byte(at1, 0x6f) & match_byte(at10, 0x79);   // sources say
+    m[10] = match_byte(at0, 0x77) & match_byte(at1, 0x69) & match_byte(at14, 0x6d);   // witnesses claim
+    m[11] = match_byte(at0, 0x74) & match_byte(at1, 0x65) & match_byte(at18, 0x73);   // testimony indicates
+    m[12] = match_byte(at0, 0x64) & match_byte(at1, 0x69) & match_byte(at13, 0x79);   // didn't you say
+    m[13] = match_byte(at0, 0x79) & match_byte(at1, 0x6f) & match_byte(at12, 0x64);   // you mentioned
+    m[14] = match_byte(at0, 0x61) & match_byte(at1, 0x73) & match_byte(at11, 0x79);   // as stated by
+}
+
+// One pass per block: the block is loaded and folded once, then validated
+// as UTF-8, classified into word starts and matched while it is still in
+// registers. The shifted views (pattern check offsets, lookback) are
+// unaligned loads of the same cache lines, so memory is streamed once.
+// utf8_valid (optional) receives whether the whole text is valid UTF-8,
+// even when results fill before the end.
+uint64_t simd_search_patterns(
+    const char* text,
+    size_t text_len,
+    match_result_t* results,
+    size_t max_results,
+    bool whole_words,
+    bool* utf8_valid
+) {
+    const uint8_t* bytes = (const uint8_t*)text;
+    uint8_t padded[KERNEL_LOOKBACK + KERNEL_WINDOW];
+    uint64_t match_count = 0;
+    kernel_vec_t utf8_error = vec_zero();
+
+    for (size_t p = 0; p < text_len; p += KERNEL_LANES) {
+        const uint8_t* window = bytes + p;
+        kernel_mask_t valid = ~(kernel_mask_t)0;
+        if (p < KERNEL_LOOKBACK || text_len - p < KERNEL_WINDOW) {
+            // Head and tail: zero-padded copy, lanes past the text masked off
+            size_t before = p < KERNEL_LOOKBACK ? p : KERNEL_LOOKBACK;
+            size_t available = text_len - p < KERNEL_WINDOW ? text_len - p : KERNEL_WINDOW;
+            memset(padded, 0, sizeof(padded));
+            memcpy(padded + KERNEL_LOOKBACK - before, window - before, before + available);
+            window = padded + KERNEL_LOOKBACK;
+            if (available < KERNEL_LANES) valid = ((kernel_mask_t)1 << available) - 1;
+        }
+
+        kernel_vec_t at0 = load_folded(window);
+        kernel_vec_t prev1 = load_raw(window - 1);
+        if (match_count < max_results) {
+            kernel_mask_t m[LEGAL_PATTERN_COUNT];
+            block_candidates(window, at0, m);
+            kernel_mask_t any = 0;
+            for (int i = 0; i < LEGAL_PATTERN_COUNT; i++) any |= m[i];
+            any &= valid;
+            if (whole_words && any) {
+                any &= word_bytes(at0) & ~word_bytes(prev1);
+            }
+
+            // Offset order, then pattern ID order, like the other engines
+            while (any && match_count < max_results) {
+                unsigned lane = (unsigned)__builtin_ctzll((uint64_t)any);
+                any &= any - 1;
+                size_t pos = p + lane;
+                for (uint32_t id = 0; id < LEGAL_PATTERN_COUNT; id++) {
+                    if (!((m[id] >> lane) & 1)) continue;
+                    size_t length = kernel_lengths[id];
+                    if (length > text_len - pos) continue;
+                    if (!folded_equal(bytes + pos, (const uint8_t*)kernel_patterns[id], length)) continue;
+                    if (whole_words && !word_bounded(bytes, text_len, pos, length)) continue;
+
+                    match_result_t* match = &results[match_count++];
+                    match->offset = pos;
+                    match->length = length;
+                    match->pattern_id = id;
+                    match->confidence = 95; // Fixed confidence for demo
+                    if (match_count >= max_results) break;
+                }
+            }
+        } else if (!utf8_valid) {
+            break;
+        }
+
+        if (utf8_valid) {
+            // All-ASCII blocks (lookback included) skip the tables; zero
+            // padding after the text flags a truncated final sequence
+            kernel_vec_t prev3 = load_raw(window - 3);
+            if (high_bit(vec_or(at0, prev3))) {
+                utf8_error = vec_or(utf8_error, utf8_errors(at0, prev1, load_raw(window - 2), prev3));
+            }
+        }
+    }
+    if (utf8_valid) {
+        *utf8_valid = !vec_any(utf8_error) && !utf8_truncated(bytes, text_len);
+    }
+    return match_count;
+}
+
+static inline bool folded_match(const uint8_t* text, const uint8_t* pattern, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        if (fold_byte(text[i]) != fold_byte(pattern[i])) return false;
+    }
+    return true;
+}
+
+uint64_t simd_search_single(
+    const char* text,
+    size_t text_len,
+    const char* pattern,
+    size_t pattern_len
+) {
+    if (pattern_len == 0 || pattern_len > text_len) return UINT64_MAX;
+    const uint8_t* bytes = (const uint8_t*)text;
+    const uint8_t* needle = (const uint8_t*)pattern;
+    uint8_t first = fold_byte(needle[0]);
+    uint8_t last = fold_byte(needle[pattern_len - 1]);
+
+    size_t p = 0;
+    for (; p + KERNEL_LANES + pattern_len - 1 <= text_len; p += KERNEL_LANES) {
+        kernel_mask_t m = match_byte(load_folded(bytes + p), first) &
+                          match_byte(load_folded(bytes + p + pattern_len - 1), last);
+        while (m) {
+            size_t pos = p + (size_t)__builtin_ctzll((uint64_t)m);
+            m &= m - 1;
+            if (folded_match(bytes + pos, needle, pattern_len)) return pos;
+        }
+    }
+    for (; p + pattern_len <= text_len; p++) {
+        if (folded_match(bytes + p, needle, pattern_len)) return p;
+    }
+    return UINT64_MAX;
+}
+
+uint64_t get_pattern_count(void) {
+    return LEGAL_PATTERN_COUNT;
+}
@@ -0,0 +1,22 @@
+// Code generated by patterns/generate.go from patterns/legal_patterns.txt; DO NOT EDIT.
+
+package main
+
+// LegalPatterns lists the compiled-in hearsay patterns in pattern ID order
+var LegalPatterns = []string{
+	"he said",
+	"she said",
+	"she told",
+	"he told",
+	"i heard",
+	"according to",
+	"reportedly",
+	"allegedly",
+	"it was reported",
+	"sources say",
+	"witnesses claim",
+	"testimony indicates",
+	"didn't you say",
+	"you mentioned",
+	"as stated by",
+}
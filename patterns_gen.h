@@ -0,0 +1,28 @@
+// Code generated by patterns/generate.go from patterns/legal_patterns.txt; DO NOT EDIT.
+
+#ifndef PATTERNS_GEN_H
+#define PATTERNS_GEN_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LEGAL_PATTERN_COUNT   15
+#define LEGAL_PATTERN_MAX_LEN 19
+
+typedef struct {
+    const char* text;
+    uint32_t category;              // PATTERN_CAT_* mask
+} legal_pattern_t;
+
+// Compiled-in patterns; the index is the pattern ID
+extern const legal_pattern_t legal_patterns[LEGAL_PATTERN_COUNT];
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PATTERNS_GEN_H
@@ -0,0 +1,590 @@
+package main
+
+import (
+	"encoding/binary"
+	"errors"
+	"fmt"
+	"math"
+	"math/bits"
+	"os"
+	"path/filepath"
+	"sort"
+	"strings"
+	"time"
+)
+
+// Positional index of matcher output across an archive. Every document is
+// given a range of one global position space (documents laid end to end),
+// and each match is recorded at its global start position in two posting
+// lists: one for its pattern and one for the speaker holding the floor.
+// "Pattern P by speaker S in document D" is then the intersection of two
+// lists clipped to D's range, so no transcript is rescanned.
+//
+// Posting lists are ascending positions, delta coded in 128-entry blocks
+// bit-packed in the SIMD-BP128 layout, plus a skip table of block starts.
+//
+// File layout (little endian):
+//
+//	magic "LNPPOS01"
+//	u32 docCount, u32 speakerCount, u32 patternCount
+//	docCount x     { u16 pathLen, path, u64 base, u64 length }
+//	speakerCount x { u16 nameLen, name }
+//	patternCount x { u16 textLen, text }
+//	(patternCount + speakerCount) x u64 list offset   patterns, then speakers
+//	lists
+
+const (
+	posIndexMagic  = "LNPPOS01"
+	postingBlock   = 128
+	rawBlockWidth  = 0xFF // Block of u64 deltas (a gap did not fit 32 bits)
+	maxSpeakerName = 40
+	unattributed   = "(unattributed)"
+)
+
+// Occurrence is one indexed match
+type Occurrence struct {
+	Doc       string
+	Offset    uint64
+	PatternID uint32
+	Speaker   string // Empty unless the query named a speaker
+}
+
+type posDoc struct {
+	Path   string
+	Base   uint64
+	Length uint64
+}
+
+// PositionIndex is a loaded positional index
+type PositionIndex struct {
+	Docs     []posDoc
+	Speakers []string
+	Patterns []string
+	lists    [][]byte // Patterns first, then speakers
+}
+
+// packBlock appends 128 w-bit deltas in the SIMD-BP128 layout: value i
+// sits in lane i%4 at bit (i/4)*w of that lane, and word k of the four
+// lanes forms the k-th 16-byte vector, so a 128-bit unpacker decodes four
+// values per shift/mask and a block is exactly w vectors.
+func packBlock(dst []byte, deltas *[postingBlock]uint64, w int) []byte {
+	var words [postingBlock]uint32
+	for i := 0; i < postingBlock; i++ {
+		lane, bit := i&3, (i>>2)*w
+		k, shift := bit>>5, bit&31
+		v := uint32(deltas[i])
+		words[k*4+lane] |= v << shift
+		if shift+w > 32 {
+			words[(k+1)*4+lane] |= v >> (32 - shift)
+		}
+	}
+	for _, word := range words[:4*w] {
+		dst = binary.LittleEndian.AppendUint32(dst, word)
+	}
+	return dst
+}
+
+func unpackBlock(src []byte, w int, out *[postingBlock]uint64) {
+	mask := uint32(uint64(1)<<w - 1)
+	for i := 0; i < postingBlock; i++ {
+		lane, bit := i&3, (i>>2)*w
+		k, shift := bit>>5, bit&31
+		v := binary.LittleEndian.Uint32(src[(k*4+lane)*4:]) >> shift
+		if shift+w > 32 {
+			v |= binary.LittleEndian.Uint32(src[((k+1)*4+lane)*4:]) << (32 - shift)
+		}
+		out[i] = uint64(v & mask)
+	}
+}
+
+func blockSize(width byte) int {
+	if width == rawBlockWidth {
+		return 1 + 8*postingBlock
+	}
+	return 1 + 16*int(width)
+}
+
+// encodePostings appends a list of strictly ascending positions:
+// u32 count, u32 blocks, blocks x u64 first value, packed blocks, then the
+// count%128 tail as uvarint (first value absolute, then deltas)
+func encodePostings(dst []byte, values []uint64) []byte {
+	le := binary.LittleEndian
+	blocks := len(values) / postingBlock
+	dst = le.AppendUint32(dst, uint32(len(values)))
+	dst = le.AppendUint32(dst, uint32(blocks))
+	for b := 0; b < blocks; b++ {
+		dst = le.AppendUint64(dst, values[b*postingBlock])
+	}
+
+	var deltas [postingBlock]uint64
+	for b := 0; b < blocks; b++ {
+		block := values[b*postingBlock : (b+1)*postingBlock]
+		var all uint64
+		prev := block[0]
+		for i, v := range block {
+			deltas[i] = v - prev
+			all |= deltas[i]
+			prev = v
+		}
+		if all > math.MaxUint32 {
+			dst = append(dst, rawBlockWidth)
+			for _, d := range deltas {
+				dst = le.AppendUint64(dst, d)
+			}
+			continue
+		}
+		w := bits.Len32(uint32(all))
+		dst = append(dst, byte(w))
+		dst = packBlock(dst, &deltas, w)
+	}
+
+	var prev uint64
+	for _, v := range values[blocks*postingBlock:] {
+		dst = binary.AppendUvarint(dst, v-prev)
+		prev = v
+	}
+	return dst
+}
+
+// decodeRange appends the list's positions in [lo, hi), skipping blocks
+// that end before lo
+func decodeRange(list []byte, lo, hi uint64, out []uint64) ([]uint64, error) {
+	le := binary.LittleEndian
+	if len(list) < 8 {
+		return out, errors.New("corrupt posting list")
+	}
+	count := int(le.Uint32(list))
+	blocks := int(le.Uint32(list[4:]))
+	skip := list[8:]
+	body := skip[8*blocks:]
+
+	var deltas [postingBlock]uint64
+	for b := 0; b < blocks; b++ {
+		first := le.Uint64(skip[8*b:])
+		if first >= hi {
+			return out, nil
+		}
+		size := blockSize(body[0])
+		if b+1 < blocks && le.Uint64(skip[8*(b+1):]) <= lo {
+			body = body[size:]
+			continue
+		}
+
+		if body[0] == rawBlockWidth {
+			for i := range deltas {
+				deltas[i] = le.Uint64(body[1+8*i:])
+			}
+		} else {
+			unpackBlock(body[1:], int(body[0]), &deltas)
+		}
+		v := first
+		for _, d := range deltas {
+			v += d
+			if v >= hi {
+				return out, nil
+			}
+			if v >= lo {
+				out = append(out, v)
+			}
+		}
+		body = body[size:]
+	}
+
+	var v uint64
+	for i := blocks * postingBlock; i < count; i++ {
+		d, n := binary.Uvarint(body)
+		if n <= 0 {
+			return out, errors.New("corrupt posting list")
+		}
+		body = body[n:]
+		v += d
+		if v >= hi {
+			break
+		}
+		if v >= lo {
+			out = append(out, v)
+		}
+	}
+	return out, nil
+}
+
+// speakerTurn marks where a speaker takes the floor
+type speakerTurn struct {
+	Start   int
+	Speaker uint32
+}
+
+// speakerLabel recognizes a transcript turn such as "THE WITNESS:" or
+// "Q:" at the start of a line and returns the normalized name
+func speakerLabel(line string) (string, bool) {
+	line = strings.TrimLeft(line, " \t")
+	colon := strings.IndexByte(line, ':')
+	if colon <= 0 || colon > maxSpeakerName {
+		return "", false
+	}
+	label := line[:colon]
+	c := label[0] | 0x20
+	if c < 'a' || c > 'z' {
+		return "", false
+	}
+	for i := 1; i < len(label); i++ {
+		c := label[i]
+		if !(c|0x20 >= 'a' && c|0x20 <= 'z') && c != ' ' && c != '.' && c != '\'' && c != '-' {
+			return "", false
+		}
+	}
+	return strings.ToUpper(strings.TrimSpace(label)), true
+}
+
+// speakerTurns splits a transcript into turns; text before the first label
+// is unattributed (speaker 0)
+func speakerTurns(text string, speakerIDs map[string]uint32, speakers *[]string) []speakerTurn {
+	turns := []speakerTurn{{Start: 0, Speaker: 0}}
+	for start := 0; start < len(text); {
+		end := strings.IndexByte(text[start:], '\n')
+		if end < 0 {
+			end = len(text)
+		} else {
+			end += start
+		}
+		if name, ok := speakerLabel(text[start:end]); ok {
+			id, known := speakerIDs[name]
+			if !known {
+				id = uint32(len(*speakers))
+				speakerIDs[name] = id
+				*speakers = append(*speakers, name)
+			}
+			turns = append(turns, speakerTurn{Start: start, Speaker: id})
+		}
+		start = end + 1
+	}
+	return turns
+}
+
+func speakerAt(turns []speakerTurn, offset int) uint32 {
+	i := sort.Search(len(turns), func(i int) bool { return turns[i].Start > offset })
+	return turns[i-1].Speaker
+}
+
+// BuildPositionIndex matches patterns against every file under root and
+// writes the positional index to indexPath
+func BuildPositionIndex(root, indexPath string, patterns []string) (int, error) {
+	root, err := filepath.Abs(root)
+	if err != nil {
+		return 0, err
+	}
+	files, err := listArchive(root)
+	if err != nil {
+		return 0, err
+	}
+
+	matcher := NewPureMatcherWithPatterns(patterns)
+	speakers := []string{unattributed}
+	speakerIDs := map[string]uint32{unattributed: 0}
+	patternPositions := make([][]uint64, len(patterns))
+	var speakerPositions [][]uint64
+	docs := make([]posDoc, 0, len(files))
+	var base uint64
+	matches := 0
+
+	for _, file := range files {
+		data, err := os.ReadFile(filepath.Join(root, filepath.FromSlash(file.Path)))
+		if err != nil {
+			return 0, err
+		}
+		text := string(data)
+		docs = append(docs, posDoc{Path: file.Path, Base: base, Length: uint64(len(text))})
+		turns := speakerTurns(text, speakerIDs, &speakers)
+		for len(speakerPositions) < len(speakers) {
+			speakerPositions = append(speakerPositions, nil)
+		}
+
+		// Per pattern, matches come back in offset order; per speaker they
+		// are merged across patterns below
+		results := matcher.SearchUncached(text)
+		sort.Slice(results, func(i, j int) bool { return results[i].Offset < results[j].Offset })
+		for _, r := range results {
+			pos := base + r.Offset
+			patternPositions[r.PatternID] = append(patternPositions[r.PatternID], pos)
+			s := speakerAt(turns, int(r.Offset))
+			if list := speakerPositions[s]; len(list) == 0 || list[len(list)-1] != pos {
+				speakerPositions[s] = append(list, pos)
+			}
+		}
+		matches += len(results)
+		// One byte gap keeps a match from running into the next document
+		base += uint64(len(text)) + 1
+	}
+
+	le := binary.LittleEndian
+	out := []byte(posIndexMagic)
+	out = le.AppendUint32(out, uint32(len(docs)))
+	out = le.AppendUint32(out, uint32(len(speakers)))
+	out = le.AppendUint32(out, uint32(len(patterns)))
+	for _, d := range docs {
+		out = appendString16(out, d.Path)
+		out = le.AppendUint64(out, d.Base)
+		out = le.AppendUint64(out, d.Length)
+	}
+	for _, s := range speakers {
+		out = appendString16(out, s)
+	}
+	for _, p := range patterns {
+		out = appendString16(out, p)
+	}
+
+	all := append(patternPositions, speakerPositions...)
+	var lists []byte
+	offsets := make([]uint64, len(all))
+	for i, positions := range all {
+		offsets[i] = uint64(len(lists))
+		lists = encodePostings(lists, positions)
+	}
+	for _, off := range offsets {
+		out = le.AppendUint64(out, off)
+	}
+	out = append(out, lists...)
+
+	tmp := indexPath + ".tmp"
+	if err := os.WriteFile(tmp, out, 0o644); err != nil {
+		return 0, err
+	}
+	return matches, os.Rename(tmp, indexPath)
+}
+
+func appendString16(dst []byte, s string) []byte {
+	dst = binary.LittleEndian.AppendUint16(dst, uint16(len(s)))
+	return append(dst, s...)
+}
+
+// posReader walks the index header
+type posReader struct {
+	data []byte
+	err  error
+}
+
+func (r *posReader) next(n int) []byte {
+	if r.err != nil || len(r.data) < n {
+		r.err = errors.New("truncated position index")
+		return make([]byte, n)
+	}
+	b := r.data[:n]
+	r.data = r.data[n:]
+	return b
+}
+
+func (r *posReader) u32() uint32 { return binary.LittleEndian.Uint32(r.next(4)) }
+func (r *posReader) u64() uint64 { return binary.LittleEndian.Uint64(r.next(8)) }
+
+func (r *posReader) string16() string {
+	n := binary.LittleEndian.Uint16(r.next(2))
+	return string(r.next(int(n)))
+}
+
+// OpenPositionIndex loads an index written by BuildPositionIndex
+func OpenPositionIndex(indexPath string) (*PositionIndex, error) {
+	data, err := os.ReadFile(indexPath)
+	if err != nil {
+		return nil, err
+	}
+	if len(data) < len(posIndexMagic) || string(data[:len(posIndexMagic)]) != posIndexMagic {
+		return nil, fmt.Errorf("%s: not a position index", indexPath)
+	}
+
+	r := &posReader{data: data[len(posIndexMagic):]}
+	ix := &PositionIndex{}
+	docCount, speakerCount, patternCount := r.u32(), r.u32(), r.u32()
+	for i := uint32(0); i < docCount && r.err == nil; i++ {
+		path := r.string16()
+		ix.Docs = append(ix.Docs, posDoc{Path: path, Base: r.u64(), Length: r.u64()})
+	}
+	for i := uint32(0); i < speakerCount && r.err == nil; i++ {
+		ix.Speakers = append(ix.Speakers, r.string16())
+	}
+	for i := uint32(0); i < patternCount && r.err == nil; i++ {
+		ix.Patterns = append(ix.Patterns, r.string16())
+	}
+	offsets := make([]uint64, patternCount+speakerCount)
+	for i := range offsets {
+		offsets[i] = r.u64()
+	}
+	if r.err != nil {
+		return nil, fmt.Errorf("%s: %w", indexPath, r.err)
+	}
+	for i, off := range offsets {
+		if off > uint64(len(r.data)) {
+			return nil, fmt.Errorf("%s: list %d out of range", indexPath, i)
+		}
+		ix.lists = append(ix.lists, r.data[off:])
+	}
+	return ix, nil
+}
+
+// PositionQuery filters occurrences; empty fields match everything
+type PositionQuery struct {
+	Speaker string
+	Pattern string
+	Doc     string
+}
+
+func (ix *PositionIndex) docAt(pos uint64) int {
+	return sort.Search(len(ix.Docs), func(i int) bool { return ix.Docs[i].Base > pos }) - 1
+}
+
+// intersectPositions keeps the positions of a also in b (both ascending)
+func intersectPositions(a, b []uint64) []uint64 {
+	out := a[:0]
+	j := 0
+	for _, v := range a {
+		for j < len(b) && b[j] < v {
+			j++
+		}
+		if j < len(b) && b[j] == v {
+			out = append(out, v)
+		}
+	}
+	return out
+}
+
+// Query returns matching occurrences in archive order, then pattern ID
+func (ix *PositionIndex) Query(q PositionQuery) ([]Occurrence, error) {
+	lo, hi := uint64(0), uint64(math.MaxUint64)
+	if q.Doc != "" {
+		d := -1
+		for i := range ix.Docs {
+			if ix.Docs[i].Path == q.Doc {
+				d = i
+			}
+		}
+		if d < 0 {
+			return nil, fmt.Errorf("unknown document %q", q.Doc)
+		}
+		lo, hi = ix.Docs[d].Base, ix.Docs[d].Base+ix.Docs[d].Length
+	}
+
+	var speakerList []uint64
+	if q.Speaker != "" {
+		name := strings.ToUpper(strings.TrimSpace(q.Speaker))
+		s := -1
+		for i, known := range ix.Speakers {
+			if known == name {
+				s = i
+			}
+		}
+		if s < 0 {
+			return nil, fmt.Errorf("unknown speaker %q", q.Speaker)
+		}
+		var err error
+		if speakerList, err = decodeRange(ix.lists[len(ix.Patterns)+s], lo, hi, nil); err != nil {
+			return nil, err
+		}
+	}
+
+	type hit struct {
+		pos uint64
+		id  uint32
+	}
+	var hits []hit
+	var positions []uint64
+	for id, pattern := range ix.Patterns {
+		if q.Pattern != "" && !strings.EqualFold(pattern, q.Pattern) {
+			continue
+		}
+		var err error
+		if positions, err = decodeRange(ix.lists[id], lo, hi, positions[:0]); err != nil {
+			return nil, err
+		}
+		if q.Speaker != "" {
+			positions = intersectPositions(positions, speakerList)
+		}
+		for _, pos := range positions {
+			hits = append(hits, hit{pos, uint32(id)})
+		}
+	}
+
+	sort.Slice(hits, func(i, j int) bool {
+		if hits[i].pos != hits[j].pos {
+			return hits[i].pos < hits[j].pos
+		}
+		return hits[i].id < hits[j].id
+	})
+	occurrences := make([]Occurrence, len(hits))
+	for i, h := range hits {
+		d := ix.docAt(h.pos)
+		occurrences[i] = Occurrence{
+			Doc:       ix.Docs[d].Path,
+			Offset:    h.pos - ix.Docs[d].Base,
+			PatternID: h.id,
+			Speaker:   strings.ToUpper(strings.TrimSpace(q.Speaker)),
+		}
+	}
+	return occurrences, nil
+}
+
+// parsePositionQuery reads key=value terms (speaker, pattern, doc)
+func parsePositionQuery(terms []string) (PositionQuery, error) {
+	var q PositionQuery
+	for _, term := range terms {
+		key, value, ok := strings.Cut(term, "=")
+		switch {
+		case !ok:
+			return q, fmt.Errorf("query term %q is not key=value", term)
+		case key == "speaker":
+			q.Speaker = value
+		case key == "pattern":
+			q.Pattern = value
+		case key == "doc":
+			q.Doc = value
+		default:
+			return q, fmt.Errorf("unknown query key %q (speaker, pattern, doc)", key)
+		}
+	}
+	return q, nil
+}
+
+// runPositionIndex indexes matches of a pattern file (default: the
+// built-in patterns) across an archive
+func runPositionIndex(archive, indexPath, patternPath string) error {
+	patterns := LegalPatterns
+	if patternPath != "" {
+		var err error
+		if patterns, err = readPatternFile(patternPath); err != nil {
+			return err
+		}
+	}
+	start := time.Now()
+	matches, err := BuildPositionIndex(archive, indexPath, patterns)
+	if err != nil {
+		return err
+	}
+	fmt.Printf("🗂️  Indexed %d matches of %d patterns into %s (%v)\n", matches, len(patterns), indexPath, time.Since(start))
+	return nil
+}
+
+// runPositionQuery answers a query against a positional index
+func runPositionQuery(indexPath string, terms []string) error {
+	q, err := parsePositionQuery(terms)
+	if err != nil {
+		return err
+	}
+	start := time.Now()
+	ix, err := OpenPositionIndex(indexPath)
+	if err != nil {
+		return err
+	}
+	occurrences, err := ix.Query(q)
+	if err != nil {
+		return err
+	}
+	elapsed := time.Since(start)
+
+	for _, o := range occurrences {
+		speaker := ""
+		if o.Speaker != "" {
+			speaker = " (" + o.Speaker + ")"
+		}
+		fmt.Printf("📍 %s:%d  \"%s\"%s\n", o.Doc, o.Offset, ix.Patterns[o.PatternID], speaker)
+	}
+	fmt.Printf("\n🔎 %d occurrences (%v)\n", len(occurrences), elapsed)
+	return nil
+}
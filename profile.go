@@ -0,0 +1,195 @@
+package main
+
+import (
+	"fmt"
+	"net/http"
+	"net/http/pprof"
+	"os"
+	"os/signal"
+	"runtime"
+	rpprof "runtime/pprof"
+	"runtime/trace"
+	"strings"
+	"sync"
+)
+
+// Sampling rates used while mutex/block profiles are being captured
+const (
+	mutexProfileFraction = 5     // Report 1 in 5 contention events
+	blockProfileRateNs   = 10000 // Sample blocking events lasting >= 10µs
+)
+
+// ProfileConfig holds the profiling outputs requested on the command line
+type ProfileConfig struct {
+	CPUProfile   string
+	MemProfile   string
+	MutexProfile string
+	BlockProfile string
+	Trace        string
+	PprofAddr    string // Serve /debug/pprof/ on this address
+}
+
+// enabled reports whether any profiling output was requested
+func (c ProfileConfig) enabled() bool {
+	return c.CPUProfile != "" || c.MemProfile != "" || c.MutexProfile != "" ||
+		c.BlockProfile != "" || c.Trace != "" || c.PprofAddr != ""
+}
+
+// parseProfileFlags strips profiling flags from args and returns the rest.
+// Both "--flag=value" and "--flag value" forms are accepted. On error the
+// arguments consumed so far are still returned so the caller can pick the
+// right output stream for the message.
+func parseProfileFlags(args []string) (ProfileConfig, []string, error) {
+	var cfg ProfileConfig
+	targets := map[string]*string{
+		"--cpuprofile":   &cfg.CPUProfile,
+		"--memprofile":   &cfg.MemProfile,
+		"--mutexprofile": &cfg.MutexProfile,
+		"--blockprofile": &cfg.BlockProfile,
+		"--trace":        &cfg.Trace,
+		"--pprof-addr":   &cfg.PprofAddr,
+	}
+
+	rest := make([]string, 0, len(args))
+	for i := 0; i < len(args); i++ {
+		name, value, hasValue := strings.Cut(args[i], "=")
+		target, ok := targets[name]
+		if !ok {
+			rest = append(rest, args[i])
+			continue
+		}
+		if !hasValue {
+			if i+1 >= len(args) {
+				return cfg, rest, fmt.Errorf("%s requires a value", name)
+			}
+			i++
+			value = args[i]
+		}
+		*target = value
+	}
+	return cfg, rest, nil
+}
+
+// startProfiling begins the requested captures and returns a function that
+// stops them and writes the profiles to disk. The stop function also runs if
+// the process is interrupted so long interactive sessions keep their data.
+func startProfiling(cfg ProfileConfig) (func(), error) {
+	if !cfg.enabled() {
+		return func() {}, nil
+	}
+
+	var stops []func()
+	var stopOnce sync.Once
+	stopAll := func() {
+		stopOnce.Do(func() {
+			for i := len(stops) - 1; i >= 0; i-- {
+				stops[i]()
+			}
+		})
+	}
+
+	if cfg.CPUProfile != "" {
+		f, err := os.Create(cfg.CPUProfile)
+		if err != nil {
+			return nil, fmt.Errorf("cpu profile: %w", err)
+		}
+		if err := rpprof.StartCPUProfile(f); err != nil {
+			f.Close()
+			return nil, fmt.Errorf("cpu profile: %w", err)
+		}
+		stops = append(stops, func() {
+			rpprof.StopCPUProfile()
+			f.Close()
+		})
+	}
+
+	if cfg.Trace != "" {
+		f, err := os.Create(cfg.Trace)
+		if err != nil {
+			stopAll()
+			return nil, fmt.Errorf("trace: %w", err)
+		}
+		if err := trace.Start(f); err != nil {
+			f.Close()
+			stopAll()
+			return nil, fmt.Errorf("trace: %w", err)
+		}
+		stops = append(stops, func() {
+			trace.Stop()
+			f.Close()
+		})
+	}
+
+	// Contention sampling is off by default; enable it for the file outputs
+	// and for the HTTP endpoints, which would otherwise report nothing.
+	if cfg.MutexProfile != "" || cfg.PprofAddr != "" {
+		runtime.SetMutexProfileFraction(mutexProfileFraction)
+	}
+	if cfg.BlockProfile != "" || cfg.PprofAddr != "" {
+		runtime.SetBlockProfileRate(blockProfileRateNs)
+	}
+
+	snapshots := []struct{ path, profile string }{
+		{cfg.MemProfile, "heap"},
+		{cfg.MutexProfile, "mutex"},
+		{cfg.BlockProfile, "block"},
+	}
+	for _, s := range snapshots {
+		if s.path == "" {
+			continue
+		}
+		path, profile := s.path, s.profile
+		stops = append(stops, func() {
+			if err := writeProfile(path, profile); err != nil {
+				fmt.Fprintf(os.Stderr, "❌ %s profile: %v\n", profile, err)
+			}
+		})
+	}
+
+	if cfg.PprofAddr != "" {
+		go servePprof(cfg.PprofAddr)
+	}
+
+	// Flush captures on Ctrl-C; interactive mode otherwise never returns
+	interrupts := make(chan os.Signal, 1)
+	signal.Notify(interrupts, os.Interrupt)
+	go func() {
+		<-interrupts
+		stopAll()
+		os.Exit(130)
+	}()
+
+	return func() {
+		signal.Stop(interrupts)
+		stopAll()
+	}, nil
+}
+
+// writeProfile writes a named runtime profile snapshot to path
+func writeProfile(path, profile string) error {
+	f, err := os.Create(path)
+	if err != nil {
+		return err
+	}
+	defer f.Close()
+
+	if profile == "heap" {
+		runtime.GC() // Report up-to-date live objects
+	}
+	return rpprof.Lookup(profile).WriteTo(f, 0)
+}
+
+// servePprof exposes the on-demand /debug/pprof/ endpoints
+func servePprof(addr string) {
+	mux := http.NewServeMux()
+	mux.HandleFunc("/debug/pprof/", pprof.Index)
+	mux.HandleFunc("/debug/pprof/cmdline", pprof.Cmdline)
+	mux.HandleFunc("/debug/pprof/profile", pprof.Profile)
+	mux.HandleFunc("/debug/pprof/symbol", pprof.Symbol)
+	mux.HandleFunc("/debug/pprof/trace", pprof.Trace)
+
+	fmt.Fprintf(os.Stderr, "🔬 pprof endpoints on http://%s/debug/pprof/\n", addr)
+	if err := http.ListenAndServe(addr, mux); err != nil {
+		fmt.Fprintf(os.Stderr, "❌ pprof server: %v\n", err)
+	}
+}
@@ -0,0 +1,248 @@
+#include "rabin_karp.h"
+#include "roaring.h"
+#include <stdlib.h>
+#include <string.h>
+#include <immintrin.h>
+
+#ifdef __AVX512F__
+#define RK_LANES 16
+#else
+#define RK_LANES 8
+#endif
+
+// Per-search buffers, all from the scratch arena
+typedef struct {
+    uint8_t* folded;                // Folded span bytes, zero past the text
+    uint32_t* w4;                   // 4-byte window polynomials
+    uint32_t* w8;                   // 8-byte window polynomials
+    uint32_t* w16;                  // 16-byte window polynomials (AVX-512 roll)
+    size_t window_count;            // Roll-window entries needed per span
+    match_result_t* pending;        // Matches of the current span
+    size_t pending_count;
+    size_t pending_capacity;
+    arena_t* arena;
+} rk_span_t;
+
+static uint32_t base_power(uint32_t exponent) {
+    uint32_t power = 1;
+    while (exponent--) power *= FINGERPRINT_BASE;
+    return power;
+}
+
+// Case-fold count bytes of text from start; bytes past the end read as 0
+static void fold_span(const uint8_t* text, size_t text_len, size_t start, uint8_t* out, size_t count) {
+    const __m256i upper_a = _mm256_set1_epi8('A');
+    const __m256i span_az = _mm256_set1_epi8(25);
+    const __m256i case_bit = _mm256_set1_epi8(0x20);
+    size_t i = 0;
+    for (; i + 32 <= count && start + i + 32 <= text_len; i += 32) {
+        __m256i bytes = _mm256_loadu_si256((const __m256i*)(text + start + i));
+        __m256i offset = _mm256_sub_epi8(bytes, upper_a);
+        __m256i upper = _mm256_cmpeq_epi8(_mm256_min_epu8(offset, span_az), offset);
+        _mm256_storeu_si256((__m256i*)(out + i), _mm256_or_si256(bytes, _mm256_and_si256(upper, case_bit)));
+    }
+    for (; i < count; i++) {
+        out[i] = start + i < text_len ? fold_byte(text[start + i]) : 0;
+    }
+}
+
+// Window polynomials shared by every length group of the span:
+// W4 by Horner over 4 shifted byte loads, then W8 = W4 * B^4 + W4(+4)
+// and W16 = W8 * B^8 + W8(+8)
+static void window_polynomials(rk_span_t* span) {
+    const __m256i base = _mm256_set1_epi32((int)FINGERPRINT_BASE);
+    const __m256i base4 = _mm256_set1_epi32((int)base_power(4));
+    const __m256i base8 = _mm256_set1_epi32((int)base_power(8));
+    size_t count = span->window_count;
+
+    for (size_t q = 0; q < count + 24; q += 8) {
+        __m256i acc = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(span->folded + q)));
+        for (int k = 1; k < 4; k++) {
+            __m256i next = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(span->folded + q + k)));
+            acc = _mm256_add_epi32(_mm256_mullo_epi32(acc, base), next);
+        }
+        _mm256_storeu_si256((__m256i*)(span->w4 + q), acc);
+    }
+    for (size_t q = 0; q < count + 16; q += 8) {
+        __m256i head = _mm256_loadu_si256((const __m256i*)(span->w4 + q));
+        __m256i tail = _mm256_loadu_si256((const __m256i*)(span->w4 + q + 4));
+        _mm256_storeu_si256((__m256i*)(span->w8 + q), _mm256_add_epi32(_mm256_mullo_epi32(head, base4), tail));
+    }
+#if RK_LANES == 16
+    for (size_t q = 0; q < count; q += 8) {
+        __m256i head = _mm256_loadu_si256((const __m256i*)(span->w8 + q));
+        __m256i tail = _mm256_loadu_si256((const __m256i*)(span->w8 + q + 8));
+        _mm256_storeu_si256((__m256i*)(span->w16 + q), _mm256_add_epi32(_mm256_mullo_epi32(head, base8), tail));
+    }
+#else
+    (void)base8;
+#endif
+}
+
+static int append_pending(rk_span_t* span, size_t offset, uint32_t length, uint32_t id) {
+    if (span->pending_count == span->pending_capacity) {
+        size_t capacity = span->pending_capacity * 2;
+        match_result_t* grown = arena_alloc(span->arena, capacity * sizeof(match_result_t));
+        if (!grown) return -1;
+        memcpy(grown, span->pending, span->pending_count * sizeof(match_result_t));
+        span->pending = grown;
+        span->pending_capacity = capacity;
+    }
+    match_result_t* match = &span->pending[span->pending_count++];
+    match->offset = offset;
+    match->length = length;
+    match->pattern_id = id;
+    match->confidence = 95; // Fixed confidence for demo
+    return 0;
+}
+
+// Filter survivors: MPH probe, then compare against the folded span
+static int verify_lanes(const pattern_table_t* table, rk_span_t* span, const uint8_t* text,
+                        size_t text_len, size_t start, size_t p, uint32_t hits,
+                        const uint32_t* hashes, uint32_t length, bool whole_words) {
+    while (hits) {
+        unsigned lane = (unsigned)_tzcnt_u32(hits);
+        hits &= hits - 1;
+        size_t pos = p + lane;
+
+        const pattern_hash_entry_t* entry = pt_lookup(table, length, hashes[lane]);
+        if (!entry) continue;
+        if (whole_words && !word_bounded(text, text_len, pos, length)) continue;
+
+        const uint32_t* ids = pt_entry_ids(table, entry);
+        const uint8_t* window = span->folded + (pos - start);
+        for (uint32_t k = 0; k < entry->count; k++) {
+            if (memcmp(window, pt_pattern(table, ids[k]), length) != 0) continue;
+            if (append_pending(span, pos, length, ids[k]) != 0) return -1;
+        }
+    }
+    return 0;
+}
+
+// Roll one length group across positions [start, end) of the span
+static int scan_group(const pattern_table_t* table, rk_span_t* span, const uint8_t* text,
+                      size_t text_len, size_t start, size_t end, uint32_t length, bool whole_words) {
+    const uint32_t* filter = (const uint32_t*)pt_fp_filter(table);
+    const __m128i shift = _mm_cvtsi32_si128((int)(32 - table->fp_filter_log2));
+    uint32_t hashes[RK_LANES];
+
+    // Direct hashes seed the first vector; every later one is rolled
+    for (int lane = 0; lane < RK_LANES; lane++) {
+        hashes[lane] = pattern_fingerprint(span->folded + lane, length);
+    }
+
+#if RK_LANES == 16
+    const __m512i step_power = _mm512_set1_epi32((int)base_power(16));
+    const __m512i length_power = _mm512_set1_epi32((int)base_power(length));
+    const __m512i salt = _mm512_set1_epi32((int)fp_length_salt(length));
+    const __m512i golden = _mm512_set1_epi32((int)0x9e3779b1u);
+    const __m512i one = _mm512_set1_epi32(1);
+    const __m512i low5 = _mm512_set1_epi32(31);
+    __m512i h = _mm512_loadu_si512(hashes);
+
+    for (size_t p = start; p < end; p += 16) {
+        __m512i index = _mm512_srl_epi32(_mm512_mullo_epi32(_mm512_xor_si512(h, salt), golden), shift);
+        __m512i words = _mm512_i32gather_epi32(_mm512_srli_epi32(index, 5), filter, 4);
+        __m512i bits = _mm512_sllv_epi32(one, _mm512_and_si512(index, low5));
+        uint32_t hits = _mm512_test_epi32_mask(words, bits);
+        if (end - p < 16) hits &= (1u << (end - p)) - 1;
+        if (hits) {
+            _mm512_storeu_si512(hashes, h);
+            if (verify_lanes(table, span, text, text_len, start, p, hits, hashes, length, whole_words) != 0) return -1;
+        }
+
+        size_t q = p - start;
+        __m512i incoming = _mm512_loadu_si512(span->w16 + q + length);
+        __m512i outgoing = _mm512_mullo_epi32(_mm512_loadu_si512(span->w16 + q), length_power);
+        h = _mm512_add_epi32(_mm512_mullo_epi32(h, step_power), _mm512_sub_epi32(incoming, outgoing));
+    }
+#else
+    const __m256i step_power = _mm256_set1_epi32((int)base_power(8));
+    const __m256i length_power = _mm256_set1_epi32((int)base_power(length));
+    const __m256i salt = _mm256_set1_epi32((int)fp_length_salt(length));
+    const __m256i golden = _mm256_set1_epi32((int)0x9e3779b1u);
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i low5 = _mm256_set1_epi32(31);
+    __m256i h = _mm256_loadu_si256((const __m256i*)hashes);
+
+    for (size_t p = start; p < end; p += 8) {
+        __m256i index = _mm256_srl_epi32(_mm256_mullo_epi32(_mm256_xor_si256(h, salt), golden), shift);
+        __m256i words = _mm256_i32gather_epi32((const int*)filter, _mm256_srli_epi32(index, 5), 4);
+        __m256i bits = _mm256_sllv_epi32(one, _mm256_and_si256(index, low5));
+        __m256i miss = _mm256_cmpeq_epi32(_mm256_and_si256(words, bits), _mm256_setzero_si256());
+        uint32_t hits = ~(uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(miss)) & 0xff;
+        if (end - p < 8) hits &= (1u << (end - p)) - 1;
+        if (hits) {
+            _mm256_storeu_si256((__m256i*)hashes, h);
+            if (verify_lanes(table, span, text, text_len, start, p, hits, hashes, length, whole_words) != 0) return -1;
+        }
+
+        size_t q = p - start;
+        __m256i incoming = _mm256_loadu_si256((const __m256i*)(span->w8 + q + length));
+        __m256i outgoing = _mm256_mullo_epi32(_mm256_loadu_si256((const __m256i*)(span->w8 + q)), length_power);
+        h = _mm256_add_epi32(_mm256_mullo_epi32(h, step_power), _mm256_sub_epi32(incoming, outgoing));
+    }
+#endif
+    return 0;
+}
+
+static int compare_matches(const void* a, const void* b) {
+    const match_result_t* x = a;
+    const match_result_t* y = b;
+    if (x->offset != y->offset) return x->offset < y->offset ? -1 : 1;
+    return x->pattern_id < y->pattern_id ? -1 : (x->pattern_id > y->pattern_id);
+}
+
+uint64_t rk_search(
+    const pattern_table_t* table,
+    matcher_scratch_t* scratch,
+    bool whole_words,
+    const char* text,
+    size_t text_len,
+    match_result_t* results,
+    size_t max_results
+) {
+    if (table->count == 0 || text_len < table->min_len) return 0;
+    const uint8_t* bytes = (const uint8_t*)text;
+    const uint32_t* groups = pt_length_groups(table);
+
+    arena_reset(&scratch->arena);
+    rk_span_t span = {0};
+    span.arena = &scratch->arena;
+    span.window_count = (RK_SPAN + table->max_len + 15) & ~(size_t)15;
+    size_t fold_count = span.window_count + 64;
+    span.folded = arena_alloc(span.arena, fold_count);
+    span.w4 = arena_alloc(span.arena, (span.window_count + 32) * sizeof(uint32_t));
+    span.w8 = arena_alloc(span.arena, (span.window_count + 32) * sizeof(uint32_t));
+    span.w16 = arena_alloc(span.arena, (span.window_count + 32) * sizeof(uint32_t));
+    span.pending_capacity = 256;
+    span.pending = arena_alloc(span.arena, span.pending_capacity * sizeof(match_result_t));
+    if (!span.folded || !span.w4 || !span.w8 || !span.w16 || !span.pending) return MATCHER_SEARCH_FAILED;
+
+    uint64_t match_count = 0;
+    for (size_t start = 0; start < text_len && match_count < max_results; start += RK_SPAN) {
+        fold_span(bytes, text_len, start, span.folded, fold_count);
+        window_polynomials(&span);
+        span.pending_count = 0;
+
+        // Groups ascend by length, so once one runs out of text all do
+        for (uint32_t g = 0; g < table->length_group_count; g++) {
+            uint32_t length = groups[g];
+            if (text_len < length) break;
+            size_t end = text_len - length + 1;
+            if (end > start + RK_SPAN) end = start + RK_SPAN;
+            if (end <= start) break;
+            if (scan_group(table, &span, bytes, text_len, start, end, length, whole_words) != 0) {
+                return MATCHER_SEARCH_FAILED;   // Pending list could not grow
+            }
+        }
+
+        qsort(span.pending, span.pending_count, sizeof(match_result_t), compare_matches);
+        size_t take = span.pending_count;
+        if (take > max_results - match_count) take = max_results - match_count;
+        memcpy(results + match_count, span.pending, take * sizeof(match_result_t));
+        match_count += take;
+    }
+
+    return match_count;
+}
@@ -0,0 +1,40 @@
+#ifndef RABIN_KARP_H
+#define RABIN_KARP_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "matcher.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RK_SPAN              1024           // Text positions hashed per pass (tables stay in L1)
+#define RK_AUTO_MIN_PATTERNS 256            // Auto-select above this many patterns...
+#define RK_AUTO_MIN_LENGTH   8              // ...when none is shorter than this
+
+// Rabin-Karp scan over the pattern table's length groups. For every span,
+// the folded text is turned into 8-byte window polynomials once; each
+// length group then rolls its hash 8 lanes (AVX2) or 16 lanes (AVX-512) at
+// a time with two multiplies:
+//   h(p + 8) = h(p) * B^8 + W8(p + L) - W8(p) * B^L
+// Lanes are screened against the fingerprint filter with one gather, and
+// survivors go through the minimal perfect hash and a byte compare.
+// Results come out in offset order, like the prefilter engine. Returns
+// MATCHER_SEARCH_FAILED when the scratch arena cannot grow.
+uint64_t rk_search(
+    const pattern_table_t* table,
+    matcher_scratch_t* scratch,
+    bool whole_words,
+    const char* text,
+    size_t text_len,
+    match_result_t* results,
+    size_t max_results
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RABIN_KARP_H
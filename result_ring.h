@@ -0,0 +1,89 @@
+#ifndef RESULT_RING_H
+#define RESULT_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Marks the last record of a document; offset carries its match count
+#define RING_DOC_END UINT32_MAX
+
+// RING_DOC_END offset of a document that could not be scanned
+#define RING_DOC_ERROR UINT64_MAX
+
+// Compact match record as seen by ring consumers
+typedef struct {
+    uint64_t doc_id;                // pool_job_t.doc_id of the source document
+    uint64_t offset;                // Byte offset, or match count (RING_DOC_ERROR) for RING_DOC_END
+    uint32_t pattern_id;            // Pattern ID, or RING_DOC_END
+    uint32_t length;                // Matched length in bytes
+} ring_match_t;
+
+// Single-producer/single-consumer ring shared between one C worker and one
+// consumer (C or Go). head/tail are plain integers accessed only through
+// __atomic builtins so cgo can map the struct; Go uses sync/atomic on them.
+// Alignment uses the GNU attribute so the layout is the same in C, C++ and cgo.
+typedef struct {
+    uint64_t head __attribute__((aligned(64)));     // Next record to consume (consumer-owned)
+    uint64_t tail __attribute__((aligned(64)));     // Next record to fill (producer-owned)
+    uint64_t capacity __attribute__((aligned(64))); // Record slots (power of two)
+    uint64_t mask;
+    ring_match_t records[] __attribute__((aligned(64)));
+} result_ring_t;
+
+static inline size_t result_ring_bytes(uint64_t capacity) {
+    return sizeof(result_ring_t) + capacity * sizeof(ring_match_t);
+}
+
+static inline void result_ring_init(result_ring_t* ring, uint64_t capacity) {
+    ring->head = 0;
+    ring->tail = 0;
+    ring->capacity = capacity;
+    ring->mask = capacity - 1;
+}
+
+// Producer: append up to count records; returns how many fit
+static inline size_t result_ring_push_bulk(result_ring_t* ring, const ring_match_t* records, size_t count) {
+    uint64_t tail = ring->tail;     // Only the producer writes tail
+    uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint64_t space = ring->capacity - (tail - head);
+    if (count > space) count = space;
+    if (count == 0) return 0;
+
+    uint64_t start = tail & ring->mask;
+    uint64_t first = ring->capacity - start;
+    if (first > count) first = count;
+    memcpy(&ring->records[start], records, first * sizeof(ring_match_t));
+    memcpy(&ring->records[0], records + first, (count - first) * sizeof(ring_match_t));
+
+    __atomic_store_n(&ring->tail, tail + count, __ATOMIC_RELEASE);
+    return count;
+}
+
+// Consumer: remove up to max records; returns how many were copied
+static inline size_t result_ring_pop_bulk(result_ring_t* ring, ring_match_t* out, size_t max) {
+    uint64_t head = ring->head;     // Only the consumer writes head
+    uint64_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    uint64_t count = tail - head;
+    if (count > max) count = max;
+    if (count == 0) return 0;
+
+    uint64_t start = head & ring->mask;
+    uint64_t first = ring->capacity - start;
+    if (first > count) first = count;
+    memcpy(out, &ring->records[start], first * sizeof(ring_match_t));
+    memcpy(out + first, &ring->records[0], (count - first) * sizeof(ring_match_t));
+
+    __atomic_store_n(&ring->head, head + count, __ATOMIC_RELEASE);
+    return count;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RESULT_RING_H
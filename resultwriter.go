@@ -0,0 +1,241 @@
+package main
+
+import (
+	"encoding/binary"
+	"fmt"
+	"io"
+	"os"
+	"path/filepath"
+	"strconv"
+	"sync"
+	"time"
+)
+
+// Batched result output for bulk modes. Records are formatted straight
+// into pooled 64 KB buffers (no fmt, no per-match allocation); full
+// buffers queue up and go out together, with one writev per batch when
+// the destination is a file or pipe on Linux.
+//
+// Text format, one tab-separated line per match (context is 10 bytes
+// either side, tabs and newlines blanked):
+//
+//	path  offset  length  pattern_id  text  context
+//
+// Binary format, little-endian after the 8-byte magic "LNPRES01":
+//
+//	u8 1, u32 pattern, u16 len, text      pattern table, before any match
+//	u8 2, u32 doc, u16 len, path          document, before its matches
+//	u8 3, u32 doc, u32 pattern, u64 offset, u32 length, u8 confidence
+
+const (
+	resultBufferSize   = 64 << 10
+	resultBatchBuffers = 16 // Buffers per writev (1 MB)
+	resultContext      = 10
+
+	resultRecordPattern  = 1
+	resultRecordDocument = 2
+	resultRecordMatch    = 3
+)
+
+var resultBufferPool = sync.Pool{
+	New: func() any {
+		b := make([]byte, 0, resultBufferSize)
+		return &b
+	},
+}
+
+// ResultFormat selects the ResultWriter encoding
+type ResultFormat int
+
+const (
+	ResultText ResultFormat = iota
+	ResultBinary
+)
+
+// ResultWriterStats counts what a ResultWriter emitted
+type ResultWriterStats struct {
+	Records int64
+	Bytes   int64
+	Writes  int64 // System calls (or Write calls) issued
+}
+
+// ResultWriter formats matches into pooled buffers and writes them in
+// batches. Not safe for concurrent use.
+type ResultWriter struct {
+	w       io.Writer
+	file    *os.File // Non-nil when writev can be used
+	format  ResultFormat
+	cur     *[]byte
+	pending []*[]byte
+	batch   [][]byte
+	iovs    []iovec // Reused by the writev path
+	doc     uint32
+	path    string
+	err     error
+	stats   ResultWriterStats
+}
+
+// NewResultWriter writes matches to w; patterns resolve pattern IDs
+func NewResultWriter(w io.Writer, format ResultFormat, patterns []string) *ResultWriter {
+	rw := &ResultWriter{w: w, format: format, cur: resultBufferPool.Get().(*[]byte)}
+	if f, ok := w.(*os.File); ok && writevSupported {
+		rw.file = f
+	}
+	if format == ResultBinary {
+		*rw.cur = append(*rw.cur, "LNPRES01"...)
+		for id, p := range patterns {
+			*rw.cur = append(*rw.cur, resultRecordPattern)
+			*rw.cur = binary.LittleEndian.AppendUint32(*rw.cur, uint32(id))
+			*rw.cur = appendString16(*rw.cur, p)
+		}
+	}
+	return rw
+}
+
+// Document starts the matches of one document
+func (rw *ResultWriter) Document(id uint32, path string) {
+	rw.doc, rw.path = id, path
+	if rw.format == ResultBinary {
+		b := append(*rw.cur, resultRecordDocument)
+		b = binary.LittleEndian.AppendUint32(b, id)
+		*rw.cur = appendString16(b, path)
+		rw.rotate()
+	}
+}
+
+// appendTSVField appends s with tabs and line breaks blanked
+func appendTSVField(dst []byte, s string) []byte {
+	for i := 0; i < len(s); i++ {
+		c := s[i]
+		if c == '\t' || c == '\n' || c == '\r' {
+			c = ' '
+		}
+		dst = append(dst, c)
+	}
+	return dst
+}
+
+// Match records one match of the current document; text is the document
+func (rw *ResultWriter) Match(text string, r MatchResult) {
+	b := *rw.cur
+	if rw.format == ResultBinary {
+		b = append(b, resultRecordMatch)
+		b = binary.LittleEndian.AppendUint32(b, rw.doc)
+		b = binary.LittleEndian.AppendUint32(b, r.PatternID)
+		b = binary.LittleEndian.AppendUint64(b, r.Offset)
+		b = binary.LittleEndian.AppendUint32(b, uint32(r.Length))
+		b = append(b, uint8(r.Confidence))
+	} else {
+		start, end := int(r.Offset), int(r.Offset+r.Length)
+		lo, hi := max(start-resultContext, 0), min(end+resultContext, len(text))
+		b = appendTSVField(b, rw.path)
+		b = append(b, '\t')
+		b = strconv.AppendUint(b, r.Offset, 10)
+		b = append(b, '\t')
+		b = strconv.AppendUint(b, r.Length, 10)
+		b = append(b, '\t')
+		b = strconv.AppendUint(b, uint64(r.PatternID), 10)
+		b = append(b, '\t')
+		b = appendTSVField(b, text[start:end])
+		b = append(b, '\t')
+		b = appendTSVField(b, text[lo:hi])
+		b = append(b, '\n')
+	}
+	*rw.cur = b
+	rw.stats.Records++
+	rw.rotate()
+}
+
+// rotate queues the current buffer once full, and flushes full batches
+func (rw *ResultWriter) rotate() {
+	if len(*rw.cur) < resultBufferSize {
+		return
+	}
+	rw.pending = append(rw.pending, rw.cur)
+	rw.cur = resultBufferPool.Get().(*[]byte)
+	if len(rw.pending) >= resultBatchBuffers {
+		rw.flushPending()
+	}
+}
+
+func (rw *ResultWriter) flushPending() {
+	if len(rw.pending) == 0 {
+		return
+	}
+	if rw.err == nil {
+		rw.batch = rw.batch[:0]
+		for _, b := range rw.pending {
+			rw.batch = append(rw.batch, *b)
+			rw.stats.Bytes += int64(len(*b))
+		}
+		if rw.file != nil {
+			rw.err = rw.writev(rw.batch)
+		} else {
+			for _, b := range rw.batch {
+				if _, rw.err = rw.w.Write(b); rw.err != nil {
+					break
+				}
+				rw.stats.Writes++
+			}
+		}
+	}
+	for i, b := range rw.pending {
+		*b = (*b)[:0]
+		resultBufferPool.Put(b)
+		rw.pending[i] = nil
+	}
+	rw.pending = rw.pending[:0]
+}
+
+// Flush writes everything buffered so far
+func (rw *ResultWriter) Flush() error {
+	if len(*rw.cur) > 0 {
+		rw.pending = append(rw.pending, rw.cur)
+		rw.cur = resultBufferPool.Get().(*[]byte)
+	}
+	rw.flushPending()
+	return rw.err
+}
+
+// Stats returns what has been written so far
+func (rw *ResultWriter) Stats() ResultWriterStats {
+	return rw.stats
+}
+
+// runDump writes every match of an archive to stdout
+func runDump(root string, format ResultFormat) error {
+	files, err := listArchive(root)
+	if err != nil {
+		return err
+	}
+	start := time.Now()
+	matcher := NewPureMatcher()
+	out := NewResultWriter(os.Stdout, format, matcher.patterns)
+	var results []MatchResult
+	var scanned int64
+
+	for id, file := range files {
+		data, err := os.ReadFile(filepath.Join(root, filepath.FromSlash(file.Path)))
+		if err != nil {
+			return err
+		}
+		text := string(data)
+		scanned += int64(len(data))
+		results = matcher.AppendMatches(results[:0], text)
+		if len(results) == 0 {
+			continue
+		}
+		out.Document(uint32(id), file.Path)
+		for _, r := range results {
+			out.Match(text, r)
+		}
+	}
+	if err := out.Flush(); err != nil {
+		return err
+	}
+
+	stats := out.Stats()
+	fmt.Fprintf(os.Stderr, "📤 %d matches from %d documents (%d bytes) as %d bytes in %d writes (%v)\n",
+		stats.Records, len(files), scanned, stats.Bytes, stats.Writes, time.Since(start))
+	return nil
+}
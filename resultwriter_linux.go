@@ -0,0 +1,63 @@
+//go:build linux
+
+package main
+
+import (
+	"syscall"
+	"unsafe"
+)
+
+const writevSupported = true
+
+type iovec = syscall.Iovec
+
+// writev writes bufs with as few writev(2) calls as the kernel allows,
+// going through the runtime poller so non-blocking pipes work too
+func (rw *ResultWriter) writev(bufs [][]byte) error {
+	raw, err := rw.file.SyscallConn()
+	if err != nil {
+		return err
+	}
+	iovs := rw.iovs[:0]
+	for _, b := range bufs {
+		if len(b) > 0 {
+			iov := syscall.Iovec{Base: &b[0]}
+			iov.SetLen(len(b))
+			iovs = append(iovs, iov)
+		}
+	}
+	rw.iovs = iovs
+
+	for len(iovs) > 0 {
+		var n uintptr
+		var errno syscall.Errno
+		err := raw.Write(func(fd uintptr) bool {
+			n, _, errno = syscall.Syscall(syscall.SYS_WRITEV, fd,
+				uintptr(unsafe.Pointer(&iovs[0])), uintptr(len(iovs)))
+			return errno != syscall.EAGAIN
+		})
+		if err != nil {
+			return err
+		}
+		if errno == syscall.EINTR {
+			continue
+		}
+		if errno != 0 {
+			return errno
+		}
+		rw.stats.Writes++
+
+		// Partial write: drop finished vectors, trim the first unfinished
+		for written := int(n); written > 0; {
+			if l := int(iovs[0].Len); written >= l {
+				written -= l
+				iovs = iovs[1:]
+			} else {
+				iovs[0].Base = (*byte)(unsafe.Add(unsafe.Pointer(iovs[0].Base), written))
+				iovs[0].SetLen(l - written)
+				written = 0
+			}
+		}
+	}
+	return nil
+}
@@ -0,0 +1,18 @@
+//go:build !linux
+
+package main
+
+const writevSupported = false
+
+type iovec struct{}
+
+// writev is only reached when writevSupported is set
+func (rw *ResultWriter) writev(bufs [][]byte) error {
+	for _, b := range bufs {
+		if _, err := rw.file.Write(b); err != nil {
+			return err
+		}
+		rw.stats.Writes++
+	}
+	return nil
+}
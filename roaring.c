@@ -0,0 +1,220 @@
+#include "roaring.h"
+#include <string.h>
+#include <immintrin.h>
+
+#define ROARING_INITIAL_ARRAY 64
+
+void roaring_init(roaring_t* set, arena_t* arena) {
+    set->containers = NULL;
+    set->count = 0;
+    set->capacity = 0;
+    set->arena = arena;
+}
+
+static roaring_container_t* roaring_add_container(roaring_t* set, uint32_t key) {
+    if (set->count == set->capacity) {
+        uint32_t capacity = set->capacity ? set->capacity * 2 : 16;
+        roaring_container_t* grown = arena_alloc(set->arena, capacity * sizeof(roaring_container_t));
+        if (!grown) return NULL;
+        if (set->count) memcpy(grown, set->containers, set->count * sizeof(roaring_container_t));
+        set->containers = grown;
+        set->capacity = capacity;
+    }
+
+    roaring_container_t* c = &set->containers[set->count];
+    c->values = arena_alloc(set->arena, ROARING_INITIAL_ARRAY * sizeof(uint16_t));
+    if (!c->values) return NULL;
+    c->key = key;
+    c->cardinality = 0;
+    c->capacity = ROARING_INITIAL_ARRAY;
+    c->type = ROARING_ARRAY;
+    set->count++;
+    return c;
+}
+
+// Dense span: switch to an 8KB bitset (fixed size, O(1) insert)
+static bool container_to_bitmap(arena_t* arena, roaring_container_t* c) {
+    uint64_t* words = arena_alloc(arena, ROARING_BITMAP_WORDS * sizeof(uint64_t));
+    if (!words) return false;
+    memset(words, 0, ROARING_BITMAP_WORDS * sizeof(uint64_t));
+    for (uint32_t i = 0; i < c->cardinality; i++) {
+        uint16_t v = c->values[i];
+        words[v >> 6] |= 1ULL << (v & 63);
+    }
+    c->words = words;
+    c->type = ROARING_BITMAP;
+    return true;
+}
+
+bool roaring_append(roaring_t* set, uint64_t position) {
+    uint32_t key = (uint32_t)(position >> 16);
+    uint16_t low = (uint16_t)position;
+
+    roaring_container_t* c = set->count ? &set->containers[set->count - 1] : NULL;
+    if (!c || c->key != key) {
+        c = roaring_add_container(set, key);
+        if (!c) return false;
+    }
+
+    if (c->type == ROARING_BITMAP) {
+        c->words[low >> 6] |= 1ULL << (low & 63);
+        c->cardinality++;
+        return true;
+    }
+
+    if (c->cardinality == c->capacity) {
+        if (c->capacity >= ROARING_ARRAY_MAX) {
+            if (!container_to_bitmap(set->arena, c)) return false;
+            c->words[low >> 6] |= 1ULL << (low & 63);
+            c->cardinality++;
+            return true;
+        }
+        uint16_t* grown = arena_alloc(set->arena, c->capacity * 2 * sizeof(uint16_t));
+        if (!grown) return false;
+        memcpy(grown, c->values, c->cardinality * sizeof(uint16_t));
+        c->values = grown;
+        c->capacity *= 2;
+    }
+    c->values[c->cardinality++] = low;
+    return true;
+}
+
+uint64_t roaring_cardinality(const roaring_t* set) {
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < set->count; i++) total += set->containers[i].cardinality;
+    return total;
+}
+
+// First array slot holding a value >= lo
+static uint32_t array_lower_bound(const roaring_container_t* c, uint32_t lo) {
+    uint32_t left = 0, right = c->cardinality;
+    while (left < right) {
+        uint32_t mid = (left + right) / 2;
+        if (c->values[mid] < lo) left = mid + 1;
+        else right = mid;
+    }
+    return left;
+}
+
+void roaring_and_last(roaring_t* set, const uint64_t* mask, uint32_t lo, uint32_t hi) {
+    if (set->count == 0 || lo >= hi) return;
+    roaring_container_t* c = &set->containers[set->count - 1];
+
+    if (c->type == ROARING_ARRAY) {
+        // Sparse: probe the mask for each value in range, compacting in place
+        uint32_t out = array_lower_bound(c, lo);
+        uint32_t in = out;
+        for (; in < c->cardinality && c->values[in] < hi; in++) {
+            uint16_t v = c->values[in];
+            if (mask[v >> 6] & (1ULL << (v & 63))) c->values[out++] = v;
+        }
+        for (; in < c->cardinality; in++) c->values[out++] = c->values[in];
+        c->cardinality = out;
+        return;
+    }
+
+    // Dense: AND whole words, 256 bits per AVX2 step
+    uint32_t first = lo >> 6;
+    uint32_t full = hi >> 6;
+    uint32_t last = (hi + 63) >> 6;
+    uint64_t before = 0, after = 0;
+    uint32_t w = first;
+    for (; w + 4 <= full; w += 4) {
+        __m256i bits = _mm256_loadu_si256((const __m256i*)&c->words[w]);
+        __m256i keep = _mm256_loadu_si256((const __m256i*)&mask[w]);
+        before += _mm_popcnt_u64(c->words[w]) + _mm_popcnt_u64(c->words[w + 1]) +
+                  _mm_popcnt_u64(c->words[w + 2]) + _mm_popcnt_u64(c->words[w + 3]);
+        _mm256_storeu_si256((__m256i*)&c->words[w], _mm256_and_si256(bits, keep));
+        after += _mm_popcnt_u64(c->words[w]) + _mm_popcnt_u64(c->words[w + 1]) +
+                 _mm_popcnt_u64(c->words[w + 2]) + _mm_popcnt_u64(c->words[w + 3]);
+    }
+    for (; w < last; w++) {
+        // The final word may extend past hi: leave those bits alone
+        uint64_t keep = mask[w];
+        uint32_t word_end = (w + 1) << 6;
+        if (word_end > hi) keep |= ~0ULL << (hi & 63);
+        before += _mm_popcnt_u64(c->words[w]);
+        c->words[w] &= keep;
+        after += _mm_popcnt_u64(c->words[w]);
+    }
+    c->cardinality -= (uint32_t)(before - after);
+}
+
+void roaring_iter_last(const roaring_t* set, roaring_iter_t* it, uint32_t lo, uint32_t hi) {
+    it->container = set->count ? &set->containers[set->count - 1] : NULL;
+    it->end = hi;
+    it->word = 0;
+    it->index = 0;
+    if (!it->container) return;
+
+    if (it->container->type == ROARING_ARRAY) {
+        it->index = array_lower_bound(it->container, lo);
+    } else {
+        it->index = lo >> 6;
+        if (it->index < ROARING_BITMAP_WORDS) {
+            it->word = it->container->words[it->index] & (~0ULL << (lo & 63));
+        }
+    }
+}
+
+bool roaring_iter_next(roaring_iter_t* it, uint64_t* position) {
+    const roaring_container_t* c = it->container;
+    if (!c) return false;
+    uint64_t base = (uint64_t)c->key << 16;
+
+    if (c->type == ROARING_ARRAY) {
+        if (it->index >= c->cardinality || c->values[it->index] >= it->end) return false;
+        *position = base | c->values[it->index++];
+        return true;
+    }
+
+    while (it->word == 0) {
+        if (++it->index >= ROARING_BITMAP_WORDS || (it->index << 6) >= it->end) return false;
+        it->word = c->words[it->index];
+    }
+    uint32_t low = (it->index << 6) | (uint32_t)_tzcnt_u64(it->word);
+    if (low >= it->end) return false;
+    it->word &= it->word - 1;
+    *position = base | low;
+    return true;
+}
+
+// 32-bit mask of word bytes ([A-Za-z0-9] or >= 0x80) in a 32-byte vector
+static inline uint32_t word_mask_avx2(__m256i bytes) {
+    __m256i lower = _mm256_or_si256(bytes, _mm256_set1_epi8(0x20));
+    __m256i alpha = _mm256_sub_epi8(lower, _mm256_set1_epi8('a'));
+    __m256i digit = _mm256_sub_epi8(bytes, _mm256_set1_epi8('0'));
+    // Unsigned x < n  <=>  min(x, n - 1) == x
+    __m256i is_alpha = _mm256_cmpeq_epi8(_mm256_min_epu8(alpha, _mm256_set1_epi8(25)), alpha);
+    __m256i is_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+    uint32_t ascii_word = (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(is_alpha, is_digit));
+    return ascii_word | (uint32_t)_mm256_movemask_epi8(bytes);   // High bit: UTF-8 byte
+}
+
+void word_start_bits(const char* text, size_t text_len, uint64_t span_base,
+                     uint32_t lo, uint32_t hi, uint64_t* out) {
+    const uint8_t* bytes = (const uint8_t*)text;
+    uint64_t pos = span_base + lo;
+    uint64_t end = span_base + hi;
+    if (end > text_len) end = text_len;
+
+    // Word-ness of the byte before the range
+    uint64_t carry = (pos > 0 && is_word_byte(bytes[pos - 1])) ? 1 : 0;
+    uint32_t w = lo >> 6;
+
+    for (; pos + 64 <= end; pos += 64, w++) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(bytes + pos));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(bytes + pos + 32));
+        uint64_t word = (uint64_t)word_mask_avx2(a) | ((uint64_t)word_mask_avx2(b) << 32);
+        out[w] = word & ~((word << 1) | carry);
+        carry = word >> 63;
+    }
+
+    if (pos < end) {
+        uint64_t word = 0;
+        for (uint64_t i = pos; i < end; i++) {
+            if (is_word_byte(bytes[i])) word |= 1ULL << (i - pos);
+        }
+        out[w] = word & ~((word << 1) | carry);
+    }
+}
@@ -0,0 +1,86 @@
+#ifndef ROARING_H
+#define ROARING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "scratch.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ROARING_ARRAY_MAX    4096           // Array containers convert to bitmaps past this
+#define ROARING_BITMAP_WORDS 1024           // 65536 bits per bitmap container
+
+enum {
+    ROARING_ARRAY = 0,                      // Sorted uint16_t low halves
+    ROARING_BITMAP = 1                      // 8KB bitset
+};
+
+// One 64K-position span of the set
+typedef struct {
+    union {
+        uint16_t* values;                   // ROARING_ARRAY
+        uint64_t* words;                    // ROARING_BITMAP
+    };
+    uint32_t key;                           // Position >> 16
+    uint32_t cardinality;
+    uint32_t capacity;                      // Array slots allocated
+    uint32_t type;
+} roaring_container_t;
+
+// Roaring-style compressed position set, built in ascending order with all
+// storage taken from a search arena (nothing to free)
+typedef struct {
+    roaring_container_t* containers;
+    uint32_t count;
+    uint32_t capacity;
+    arena_t* arena;
+} roaring_t;
+
+// Cursor over the positions of one container
+typedef struct {
+    const roaring_container_t* container;
+    uint32_t index;                         // Next array slot / bitmap word
+    uint64_t word;                          // Remaining bits of the current word
+    uint32_t end;                           // Stop before this low-16 value (exclusive, up to 65536)
+} roaring_iter_t;
+
+void roaring_init(roaring_t* set, arena_t* arena);
+bool roaring_append(roaring_t* set, uint64_t position);   // Positions must ascend
+uint64_t roaring_cardinality(const roaring_t* set);
+
+// Keep only positions in [lo, hi) of the last container whose bit is set in
+// mask (indexed by low 16 bits; only words covering [lo, hi) are read).
+// lo must be a multiple of 64. Positions below lo are untouched.
+void roaring_and_last(roaring_t* set, const uint64_t* mask, uint32_t lo, uint32_t hi);
+
+// Iterate positions of the last container within [lo, hi) (low 16 bits)
+void roaring_iter_last(const roaring_t* set, roaring_iter_t* it, uint32_t lo, uint32_t hi);
+bool roaring_iter_next(roaring_iter_t* it, uint64_t* position);
+
+// Set bit i of out for each position lo + i in [lo, hi) that starts a word
+// (word byte not preceded by one). text is the whole document; out is
+// indexed like a bitmap container. lo must be a multiple of 64.
+void word_start_bits(const char* text, size_t text_len, uint64_t span_base,
+                     uint32_t lo, uint32_t hi, uint64_t* out);
+
+static inline bool is_word_byte(uint8_t c) {
+    uint8_t lower = c | 0x20;
+    return (uint8_t)(lower - 'a') < 26 || (uint8_t)(c - '0') < 10 || c >= 0x80;
+}
+
+// Whole-word rule shared by the engines: the match starts a word and does
+// not run into the next one
+static inline bool word_bounded(const uint8_t* text, size_t text_len, size_t pos, size_t length) {
+    if (!is_word_byte(text[pos]) || (pos > 0 && is_word_byte(text[pos - 1]))) return false;
+    size_t end = pos + length;
+    return end >= text_len || !is_word_byte(text[end - 1]) || !is_word_byte(text[end]);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ROARING_H
@@ -0,0 +1,117 @@
+#include "scratch.h"
+#include "matcher.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+// Blocks start with a header so they can be chained once retired
+#define BLOCK_HEADER ((sizeof(arena_block_t) + 63) & ~(size_t)63)
+
+static pthread_key_t g_scratch_key;
+static pthread_once_t g_scratch_key_once = PTHREAD_ONCE_INIT;
+
+static char* block_alloc(size_t capacity) {
+    char* block = aligned_alloc_64(BLOCK_HEADER + capacity);
+    if (!block) return NULL;
+    ((arena_block_t*)block)->next = NULL;
+    return block + BLOCK_HEADER;
+}
+
+static void block_free(char* base) {
+    if (base) aligned_free(base - BLOCK_HEADER);
+}
+
+int arena_init(arena_t* arena, size_t initial_size) {
+    memset(arena, 0, sizeof(*arena));
+    arena->base = block_alloc(initial_size);
+    if (!arena->base) return -1;
+    arena->capacity = initial_size;
+    arena->grow_count = 1;
+    return 0;
+}
+
+// Current block is full: retire it and continue in one at least twice as big
+void* arena_alloc_slow(arena_t* arena, size_t size) {
+    size_t capacity = arena->capacity * 2;
+    while (capacity < size) capacity *= 2;
+
+    char* base = block_alloc(capacity);
+    if (!base) return NULL;
+
+    if (arena->base) {
+        arena_block_t* old = (arena_block_t*)(arena->base - BLOCK_HEADER);
+        old->next = arena->retired;
+        arena->retired = old;
+        arena->retired_bytes += arena->used;
+    }
+    arena->base = base;
+    arena->capacity = capacity;
+    arena->used = size;
+    arena->grow_count++;
+    return base;
+}
+
+void arena_reset(arena_t* arena) {
+    if (arena->retired) {
+        // Merge: one block big enough for everything this search needed
+        size_t peak = arena->retired_bytes + arena->used;
+        while (arena->retired) {
+            arena_block_t* next = arena->retired->next;
+            aligned_free(arena->retired);
+            arena->retired = next;
+        }
+        if (arena->capacity < peak) {
+            size_t capacity = arena->capacity;
+            while (capacity < peak) capacity *= 2;
+            char* base = block_alloc(capacity);
+            if (base) {
+                block_free(arena->base);
+                arena->base = base;
+                arena->capacity = capacity;
+                arena->grow_count++;
+            }
+        }
+        arena->retired_bytes = 0;
+    }
+    arena->used = 0;
+}
+
+void arena_destroy(arena_t* arena) {
+    arena_reset(arena);
+    block_free(arena->base);
+    memset(arena, 0, sizeof(*arena));
+}
+
+matcher_scratch_t* matcher_scratch_alloc(void) {
+    matcher_scratch_t* scratch = aligned_alloc_64(sizeof(*scratch));
+    if (!scratch) return NULL;
+    if (arena_init(&scratch->arena, ARENA_INITIAL_SIZE) != 0) {
+        aligned_free(scratch);
+        return NULL;
+    }
+    return scratch;
+}
+
+void matcher_scratch_free(matcher_scratch_t* scratch) {
+    if (!scratch) return;
+    arena_destroy(&scratch->arena);
+    aligned_free(scratch);
+}
+
+static void scratch_key_destroy(void* scratch) {
+    matcher_scratch_free(scratch);
+}
+
+static void scratch_key_create(void) {
+    pthread_key_create(&g_scratch_key, scratch_key_destroy);
+}
+
+matcher_scratch_t* matcher_thread_scratch(void) {
+    pthread_once(&g_scratch_key_once, scratch_key_create);
+    matcher_scratch_t* scratch = pthread_getspecific(g_scratch_key);
+    if (!scratch) {
+        scratch = matcher_scratch_alloc();
+        if (scratch) pthread_setspecific(g_scratch_key, scratch);
+    }
+    return scratch;
+}
@@ -0,0 +1,61 @@
+#ifndef SCRATCH_H
+#define SCRATCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ARENA_INITIAL_SIZE (64 * 1024)
+#define ARENA_ALIGN        16
+
+// Retired arena block, kept alive until the next reset
+typedef struct arena_block {
+    struct arena_block* next;
+} arena_block_t;
+
+// Bump allocator reset once per search. When a search outgrows the current
+// block a bigger one is started; on reset the blocks are merged into one
+// block sized for the peak, so steady-state searches never call malloc.
+typedef struct {
+    char* base;                     // Current block
+    size_t used;                    // Bytes handed out from base
+    size_t capacity;                // Size of base
+    size_t retired_bytes;           // Bytes handed out from retired blocks
+    arena_block_t* retired;         // Outgrown blocks from this search
+    uint64_t grow_count;            // Blocks allocated since init (diagnostics)
+} arena_t;
+
+// Per-thread search scratch; never share one between concurrent searches
+typedef struct {
+    arena_t arena;                  // Candidate lists and other per-search data
+} matcher_scratch_t;
+
+// Arena operations
+int arena_init(arena_t* arena, size_t initial_size);
+void* arena_alloc_slow(arena_t* arena, size_t size);
+void arena_reset(arena_t* arena);
+void arena_destroy(arena_t* arena);
+
+static inline void* arena_alloc(arena_t* arena, size_t size) {
+    size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    if (arena->capacity - arena->used < size) {
+        return arena_alloc_slow(arena, size);
+    }
+    void* ptr = arena->base + arena->used;
+    arena->used += size;
+    return ptr;
+}
+
+// Scratch lifecycle
+matcher_scratch_t* matcher_scratch_alloc(void);
+void matcher_scratch_free(matcher_scratch_t* scratch);
+matcher_scratch_t* matcher_thread_scratch(void);   // Lazily created per thread
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SCRATCH_H
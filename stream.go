@@ -0,0 +1,212 @@
+package main
+
+import (
+	"bufio"
+	"compress/bzip2"
+	"compress/gzip"
+	"errors"
+	"fmt"
+	"io"
+	"os"
+	"runtime"
+	"strings"
+	"sync"
+	"time"
+)
+
+// Pipelined scanning of compressed transcripts. One goroutine decompresses
+// into a ring of cache-sized buffers while matcher goroutines consume
+// them, so memory stays bounded by the ring and the archive never touches
+// disk decompressed. Each buffer starts with the last maxLen-1 bytes of
+// the one before it (the carry), which lets matches straddle buffers.
+
+const (
+	streamBufferSize = 256 << 10 // Fits L2 alongside the worker's string copy
+	streamRingDepth  = 2         // Buffers per matcher goroutine
+)
+
+// StreamStats describes one compressed scan
+type StreamStats struct {
+	Format            string
+	CompressedBytes   int64
+	DecompressedBytes int64
+	Buffers           int
+	Matches           int
+	Elapsed           time.Duration
+}
+
+// streamBuffer is one ring slot: carry plus freshly decompressed bytes
+type streamBuffer struct {
+	data []byte
+	end  int    // Bytes of data filled
+	seen int    // Leading bytes already matched with the previous buffer
+	base uint64 // Stream offset of data[0]
+}
+
+type countingReader struct {
+	r io.Reader
+	n int64
+}
+
+func (c *countingReader) Read(p []byte) (int, error) {
+	n, err := c.r.Read(p)
+	c.n += int64(n)
+	return n, err
+}
+
+// openDecompressor sniffs the stream format; uncompressed input passes
+// through unchanged
+func openDecompressor(r *bufio.Reader) (io.Reader, string, error) {
+	magic, _ := r.Peek(4)
+	switch {
+	case len(magic) >= 2 && magic[0] == 0x1f && magic[1] == 0x8b:
+		zr, err := gzip.NewReader(r) // Multistream: concatenated members are one stream
+		return zr, "gzip", err
+	case len(magic) >= 3 && string(magic[:3]) == "BZh":
+		return bzip2.NewReader(r), "bzip2", nil
+	case len(magic) == 4 && string(magic) == "\x28\xb5\x2f\xfd":
+		return nil, "zstd", errors.New("zstd streams are not supported; recompress with gzip or pipe through zstd -dc")
+	}
+	return r, "plain", nil
+}
+
+// ScanCompressed matches a (possibly compressed) stream. emit receives
+// each buffer's matches with stream offsets, serially but in no
+// particular buffer order.
+func ScanCompressed(r io.Reader, matcher *PureMatcher, workers int, emit func([]MatchResult)) (StreamStats, error) {
+	start := time.Now()
+	counter := &countingReader{r: r}
+	src, format, err := openDecompressor(bufio.NewReaderSize(counter, 64<<10))
+	stats := StreamStats{Format: format}
+	if err != nil {
+		return stats, err
+	}
+	if workers < 1 {
+		workers = 1
+	}
+	maxLen := 1
+	for _, p := range matcher.patterns {
+		if len(p) > maxLen {
+			maxLen = len(p)
+		}
+	}
+
+	free := make(chan *streamBuffer, workers*streamRingDepth)
+	for i := 0; i < cap(free); i++ {
+		free <- &streamBuffer{data: make([]byte, streamBufferSize+maxLen-1)} // Room for the carry
+	}
+	full := make(chan *streamBuffer, cap(free))
+	found := make(chan []MatchResult, cap(free))
+
+	var wg sync.WaitGroup
+	for w := 0; w < workers; w++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			for buf := range full {
+				text := string(buf.data[:buf.end])
+				seen, base := buf.seen, buf.base
+				free <- buf // The copy is ours; hand the slot back to the decompressor
+
+				var results []MatchResult
+				for _, m := range matcher.SearchUncached(text) {
+					if int(m.Offset+m.Length) <= seen {
+						continue // Reported by the previous buffer
+					}
+					m.Offset += base
+					m.Text = strings.Clone(m.Text)
+					results = append(results, m)
+				}
+				found <- results
+			}
+		}()
+	}
+	done := make(chan struct{})
+	go func() {
+		for results := range found {
+			stats.Matches += len(results)
+			if len(results) > 0 {
+				emit(results)
+			}
+		}
+		close(done)
+	}()
+
+	readErr := fillStream(src, maxLen, free, full, &stats)
+	close(full)
+	wg.Wait()
+	close(found)
+	<-done
+
+	stats.CompressedBytes = counter.n
+	stats.Elapsed = time.Since(start)
+	return stats, readErr
+}
+
+// fillStream is the decompressing side of the pipeline
+func fillStream(src io.Reader, maxLen int, free <-chan *streamBuffer, full chan<- *streamBuffer, stats *StreamStats) error {
+	var carry []byte
+	seen := 0
+	var base uint64
+	for {
+		buf := <-free
+		copy(buf.data, carry)
+		n, err := io.ReadFull(src, buf.data[len(carry):len(carry)+streamBufferSize])
+		eof := err == io.EOF || err == io.ErrUnexpectedEOF
+		if err != nil && !eof {
+			return err
+		}
+		stats.DecompressedBytes += int64(n)
+		end := len(carry) + n
+		buf.end, buf.seen, buf.base = end, seen, base
+
+		// Matching folds ASCII bytes one at a time, so the carry may start
+		// or end inside a UTF-8 sequence
+		cut := end - (maxLen - 1)
+		if cut < 0 {
+			cut = 0
+		}
+		carry = append(carry[:0], buf.data[cut:end]...)
+		seen = end - cut
+		base += uint64(cut)
+
+		stats.Buffers++
+		full <- buf
+		if eof {
+			return nil
+		}
+	}
+}
+
+// runStreamScan scans compressed transcripts without decompressing to disk
+func runStreamScan(paths []string) error {
+	matcher := NewPureMatcher()
+	workers := runtime.GOMAXPROCS(0) - 1 // One core decompresses
+	for _, path := range paths {
+		f, err := os.Open(path)
+		if err != nil {
+			return err
+		}
+		counts := make(map[uint32]int)
+		stats, err := ScanCompressed(f, matcher, workers, func(results []MatchResult) {
+			for _, r := range results {
+				counts[r.PatternID]++
+			}
+		})
+		f.Close()
+		if err != nil {
+			return fmt.Errorf("%s: %w", path, err)
+		}
+
+		mbps := float64(stats.DecompressedBytes) / (1 << 20) / stats.Elapsed.Seconds()
+		fmt.Printf("🗜️  %s (%s): %d matches, %d → %d bytes in %d buffers, %.1f MB/s (%v)\n",
+			path, stats.Format, stats.Matches, stats.CompressedBytes, stats.DecompressedBytes,
+			stats.Buffers, mbps, stats.Elapsed)
+		for id, name := range matcher.patterns {
+			if n := counts[uint32(id)]; n > 0 {
+				fmt.Printf("   %-22s %d\n", name, n)
+			}
+		}
+	}
+	return nil
+}
@@ -0,0 +1,132 @@
+package main
+
+import (
+	"bytes"
+	"compress/gzip"
+	"math/rand"
+	"sort"
+	"strings"
+	"sync"
+	"testing"
+)
+
+// streamEdgeText puts a long and a short trigger at every distance
+// across a buffer edge, one placement per edge, so some end inside the
+// carry; the last edges split multi-byte runes
+func streamEdgeText(rng *rand.Rand) string {
+	longest := ""
+	for _, p := range LegalPatterns {
+		if len(p) > len(longest) {
+			longest = p
+		}
+	}
+	type placement struct {
+		trigger string
+		before  int // Bytes of the trigger before the edge
+	}
+	var placements []placement
+	for _, trigger := range []string{strings.ToUpper(longest), "He Said"} {
+		for j := 1; j <= len(longest)+1; j++ {
+			placements = append(placements, placement{trigger, j})
+		}
+	}
+	splitRunes := []string{"é", "中", "😀"}
+
+	edges := len(placements) + len(splitRunes)
+	text := []byte(randomTranscript(rng, (edges+1)*streamBufferSize))
+	for k, p := range placements {
+		copy(text[(k+1)*streamBufferSize-p.before:], p.trigger)
+	}
+	for k, r := range splitRunes {
+		edge := (len(placements) + k + 1) * streamBufferSize
+		copy(text[edge-1:], r)
+	}
+	return string(text)
+}
+
+func gzipMembers(t *testing.T, text string, splits []int) []byte {
+	t.Helper()
+	var out bytes.Buffer
+	prev := 0
+	for _, at := range append(splits, len(text)) {
+		zw := gzip.NewWriter(&out)
+		if _, err := zw.Write([]byte(text[prev:at])); err != nil {
+			t.Fatal(err)
+		}
+		if err := zw.Close(); err != nil {
+			t.Fatal(err)
+		}
+		prev = at
+	}
+	return out.Bytes()
+}
+
+func TestScanCompressedMatchesSearch(t *testing.T) {
+	m := NewPureMatcher()
+	text := streamEdgeText(rand.New(rand.NewSource(5)))
+	want := sortedSearch(m, text)
+
+	straddling := 0
+	for _, r := range want {
+		if r.Offset/streamBufferSize != (r.Offset+r.Length-1)/streamBufferSize {
+			straddling++
+		}
+	}
+	if straddling < 10 {
+		t.Fatalf("only %d matches cross a buffer edge", straddling)
+	}
+
+	inputs := map[string][]byte{
+		"plain": []byte(text),
+		"gzip":  gzipMembers(t, text, nil),
+		// Member boundaries inside a trigger, at a buffer edge and off it
+		"multi-member gzip": gzipMembers(t, text, []int{1000, streamBufferSize - 3, streamBufferSize + 5,
+			3*streamBufferSize - 10, 5 * streamBufferSize}),
+	}
+	for name, input := range inputs {
+		for _, workers := range []int{1, 3} {
+			var mutex sync.Mutex
+			var got []MatchResult
+			stats, err := ScanCompressed(bytes.NewReader(input), m, workers, func(results []MatchResult) {
+				mutex.Lock()
+				got = append(got, results...)
+				mutex.Unlock()
+			})
+			if err != nil {
+				t.Fatalf("%s: %v", name, err)
+			}
+			if stats.DecompressedBytes != int64(len(text)) || stats.Matches != len(got) {
+				t.Fatalf("%s: stats %+v for %d bytes and %d matches", name, stats, len(text), len(got))
+			}
+			sort.Slice(got, func(i, j int) bool {
+				if got[i].Offset != got[j].Offset {
+					return got[i].Offset < got[j].Offset
+				}
+				return got[i].PatternID < got[j].PatternID
+			})
+			if len(got) != len(want) {
+				t.Fatalf("%s, %d workers: %d matches, want %d", name, workers, len(got), len(want))
+			}
+			for i := range got {
+				if got[i] != want[i] {
+					t.Fatalf("%s, %d workers: match %d = %+v, want %+v", name, workers, i, got[i], want[i])
+				}
+			}
+		}
+	}
+}
+
+func TestScanCompressedShortStreams(t *testing.T) {
+	m := NewPureMatcher()
+	for _, text := range []string{"", "he said", strings.Repeat("é", 10) + "she told me"} {
+		var got []MatchResult
+		if _, err := ScanCompressed(bytes.NewReader(gzipMembers(t, text, nil)), m, 2, func(r []MatchResult) {
+			got = append(got, r...)
+		}); err != nil {
+			t.Fatal(err)
+		}
+		if want := m.SearchUncached(text); len(got) != len(want) {
+			t.Errorf("%q: %d matches, want %d", text, len(got), len(want))
+		}
+	}
+}
@@ -0,0 +1,127 @@
+// Minimal perfect hash and pattern table lookup checks (make unit-tests)
+#include "mph.h"
+#include "pattern_table.h"
+#include "patterns_gen.h"
+#include "matcher.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do {                       \
+    if (!(cond)) {                                  \
+        fprintf(stderr, "FAIL %s:%d: ", __FILE__, __LINE__); \
+        fprintf(stderr, __VA_ARGS__);               \
+        fputc('\n', stderr);                        \
+        failures++;                                 \
+    }                                               \
+} while (0)
+
+static uint64_t rng_state = 0x9e3779b97f4a7c15ULL;
+
+static uint64_t next_random(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+// Every key gets its own slot in [0, n), and lookups agree with the build
+static void test_mph_permutation(size_t n) {
+    uint64_t* keys = malloc(n * sizeof(uint64_t));
+    uint32_t* slots = malloc(n * sizeof(uint32_t));
+    uint32_t* pilots = malloc(mph_bucket_count(n) * sizeof(uint32_t));
+    uint8_t* used = calloc(n, 1);
+    for (size_t i = 0; i < n; i++) keys[i] = next_random();
+
+    mph_params_t params;
+    int rc = mph_build(keys, n, &params, pilots, slots);
+    CHECK(rc == 0, "mph_build(%zu keys) failed", n);
+    if (rc == 0) {
+        CHECK(params.key_count == n, "%zu keys: %u slots", n, params.key_count);
+        for (size_t i = 0; i < n; i++) {
+            uint32_t slot = mph_slot(&params, pilots, keys[i]);
+            CHECK(slot == slots[i], "%zu keys: key %zu looks up slot %u, built %u", n, i, slot, slots[i]);
+            CHECK(slot < n && !used[slot], "%zu keys: slot %u out of range or taken twice", n, slot);
+            if (slot < n) used[slot] = 1;
+        }
+    }
+    free(keys);
+    free(slots);
+    free(pilots);
+    free(used);
+}
+
+static void test_mph_rejects_duplicates(void) {
+    uint64_t keys[] = {1, 2, 3, 2};
+    uint32_t slots[4], pilots[1];
+    mph_params_t params;
+    CHECK(mph_build(keys, 4, &params, pilots, slots) == -1, "duplicate keys were accepted");
+}
+
+// Every pattern is found through the MPH; lookups of absent keys miss
+static void test_table_lookup(const char* const* patterns, size_t count) {
+    pattern_table_t* table = pattern_table_build(patterns, NULL, count);
+    CHECK(table != NULL, "pattern_table_build(%zu patterns) failed", count);
+    if (!table) return;
+
+    uint8_t folded[64];
+    for (size_t i = 0; i < count; i++) {
+        size_t len = strlen(patterns[i]);
+        for (size_t k = 0; k < len; k++) folded[k] = fold_byte((uint8_t)patterns[i][k]);
+        const pattern_hash_entry_t* entry = pt_lookup(table, (uint32_t)len, pattern_fingerprint(folded, len));
+        bool found = false;
+        if (entry) {
+            const uint32_t* ids = pt_entry_ids(table, entry);
+            for (uint32_t k = 0; k < entry->count; k++) found |= ids[k] == i;
+        }
+        CHECK(found, "%zu patterns: \"%s\" not found", count, patterns[i]);
+    }
+
+    size_t false_hits = 0;
+    for (size_t i = 0; i < 100000; i++) {
+        uint32_t length = table->max_len + 1 + (uint32_t)(next_random() % 16);
+        if (pt_lookup(table, length, (uint32_t)next_random())) false_hits++;
+    }
+    CHECK(false_hits == 0, "%zu patterns: %zu absent keys matched", count, false_hits);
+    aligned_free(table);
+}
+
+static void test_builtin_patterns(void) {
+    const char* texts[LEGAL_PATTERN_COUNT];
+    for (size_t i = 0; i < LEGAL_PATTERN_COUNT; i++) texts[i] = legal_patterns[i].text;
+    test_table_lookup(texts, LEGAL_PATTERN_COUNT);
+}
+
+static void test_random_patterns(size_t count) {
+    char** texts = malloc(count * sizeof(char*));
+    for (size_t i = 0; i < count; i++) {
+        size_t len = 4 + next_random() % 28;
+        texts[i] = malloc(len + 1);
+        for (size_t k = 0; k < len; k++) texts[i][k] = "abcdefghijklmnopqrstuvwxyz '"[next_random() % 28];
+        texts[i][len] = '\0';
+    }
+    test_table_lookup((const char* const*)texts, count);
+    for (size_t i = 0; i < count; i++) free(texts[i]);
+    free(texts);
+}
+
+int main(void) {
+    for (size_t n = 1; n <= 64; n++) test_mph_permutation(n);
+    test_mph_permutation(1000);
+    test_mph_permutation(100000);
+    test_mph_permutation(2000000);
+    test_mph_rejects_duplicates();
+
+    test_builtin_patterns();
+    test_random_patterns(1000);
+    test_random_patterns(300000);
+
+    if (failures) {
+        fprintf(stderr, "❌ mph_test: %d failures\n", failures);
+        return 1;
+    }
+    printf("✅ mph_test passed\n");
+    return 0;
+}
@@ -0,0 +1,609 @@
+package main
+
+import (
+	"bufio"
+	"encoding/binary"
+	"errors"
+	"fmt"
+	"io"
+	"io/fs"
+	"os"
+	"path/filepath"
+	"runtime"
+	"sort"
+	"strings"
+	"sync"
+	"time"
+)
+
+// Trigram index over a transcript archive: for every case-folded byte
+// trigram, the documents containing it. A pattern can only occur in a
+// document holding all of its trigrams, so a sweep with new patterns reads
+// just those documents instead of the whole archive.
+//
+// File layout (little endian):
+//
+//	magic "LNPTRI01"
+//	u32 docCount, u32 trigramCount, u64 postingsBytes
+//	u16 rootLen, root
+//	docCount x  { u16 pathLen, path, i64 size, i64 modTimeNs }
+//	trigramCount x { u32 key, u32 docs, u64 offset }   sorted by key
+//	postings: per trigram, uvarint doc ID deltas (first one absolute)
+//
+// The document table and trigram directory are loaded on open; posting
+// lists are read from disk as queries need them.
+
+const (
+	trigramMagic     = "LNPTRI01"
+	trigramSpace     = 1 << 24 // Three bytes per key
+	trigramReadChunk = 1 << 20
+	trigramEntrySize = 16
+)
+
+// IndexedDoc is one archive document as it was when indexed
+type IndexedDoc struct {
+	Path    string // Relative to the archive root
+	Size    int64
+	ModTime int64 // UnixNano
+}
+
+type trigramEntry struct {
+	Key    uint32
+	Docs   uint32
+	Offset uint64 // Into the postings section
+}
+
+// TrigramIndex is an open index file
+type TrigramIndex struct {
+	Root         string
+	Docs         []IndexedDoc
+	file         *os.File
+	dir          []trigramEntry
+	postingsBase int64
+}
+
+// postingBuilder accumulates one trigram's delta-encoded doc IDs
+type postingBuilder struct {
+	data []byte
+	last uint32
+	docs uint32
+}
+
+// foldASCII matches fold_byte in the C core (A-Z only)
+func foldASCII(c byte) byte {
+	if c-'A' < 26 {
+		return c | 0x20
+	}
+	return c
+}
+
+func trigramKey(a, b, c byte) uint32 {
+	return uint32(foldASCII(a))<<16 | uint32(foldASCII(b))<<8 | uint32(foldASCII(c))
+}
+
+// docTrigrams collects the distinct trigrams of one file. seen is a
+// trigramSpace-bit set that is left cleared again on return.
+func docTrigrams(path string, seen []uint64, keys []uint32) ([]uint32, error) {
+	f, err := os.Open(path)
+	if err != nil {
+		return keys, err
+	}
+	defer f.Close()
+
+	// Two bytes carried across reads so trigrams spanning chunks count
+	buf := make([]byte, trigramReadChunk+2)
+	carry := 0
+	for {
+		n, err := f.Read(buf[carry:])
+		window := buf[:carry+n]
+		for i := 0; i+2 < len(window); i++ {
+			key := trigramKey(window[i], window[i+1], window[i+2])
+			if seen[key>>6]&(1<<(key&63)) == 0 {
+				seen[key>>6] |= 1 << (key & 63)
+				keys = append(keys, key)
+			}
+		}
+		if len(window) >= 2 {
+			carry = copy(buf, window[len(window)-2:])
+		} else {
+			carry = copy(buf, window)
+		}
+		if err == io.EOF {
+			break
+		}
+		if err != nil {
+			return keys, err
+		}
+	}
+
+	for _, key := range keys {
+		seen[key>>6] &^= 1 << (key & 63)
+	}
+	return keys, nil
+}
+
+// listArchive returns the regular files under root in lexical order
+func listArchive(root string) ([]IndexedDoc, error) {
+	var docs []IndexedDoc
+	err := filepath.WalkDir(root, func(path string, d fs.DirEntry, err error) error {
+		if err != nil {
+			return err
+		}
+		if !d.Type().IsRegular() {
+			return nil
+		}
+		info, err := d.Info()
+		if err != nil {
+			return err
+		}
+		rel, err := filepath.Rel(root, path)
+		if err != nil {
+			return err
+		}
+		docs = append(docs, IndexedDoc{Path: filepath.ToSlash(rel), Size: info.Size(), ModTime: info.ModTime().UnixNano()})
+		return nil
+	})
+	return docs, err
+}
+
+// BuildTrigramIndex indexes every regular file under root into indexPath
+func BuildTrigramIndex(root, indexPath string) (int, error) {
+	root, err := filepath.Abs(root)
+	if err != nil {
+		return 0, err
+	}
+	docs, err := listArchive(root)
+	if err != nil {
+		return 0, err
+	}
+	if len(docs) > int(^uint32(0)) {
+		return 0, fmt.Errorf("trigram index: %d documents exceed the 32-bit doc ID space", len(docs))
+	}
+
+	seen := make([]uint64, trigramSpace/64)
+	postings := make(map[uint32]*postingBuilder)
+	var keys []uint32
+	var scratch [binary.MaxVarintLen32]byte
+	for id, doc := range docs {
+		keys, err = docTrigrams(filepath.Join(root, filepath.FromSlash(doc.Path)), seen, keys[:0])
+		if err != nil {
+			return 0, err
+		}
+		for _, key := range keys {
+			p := postings[key]
+			if p == nil {
+				p = &postingBuilder{}
+				postings[key] = p
+			}
+			delta := uint32(id)
+			if p.docs > 0 {
+				delta -= p.last
+			}
+			n := binary.PutUvarint(scratch[:], uint64(delta))
+			p.data = append(p.data, scratch[:n]...)
+			p.last = uint32(id)
+			p.docs++
+		}
+	}
+
+	dir := make([]trigramEntry, 0, len(postings))
+	var offset uint64
+	for key, p := range postings {
+		dir = append(dir, trigramEntry{Key: key, Docs: p.docs})
+	}
+	sort.Slice(dir, func(i, j int) bool { return dir[i].Key < dir[j].Key })
+	for i := range dir {
+		dir[i].Offset = offset
+		offset += uint64(len(postings[dir[i].Key].data))
+	}
+
+	tmp := indexPath + ".tmp"
+	f, err := os.Create(tmp)
+	if err != nil {
+		return 0, err
+	}
+	w := bufio.NewWriterSize(f, 1<<20)
+	le := binary.LittleEndian
+	var hdr [16]byte
+	w.WriteString(trigramMagic)
+	le.PutUint32(hdr[0:], uint32(len(docs)))
+	le.PutUint32(hdr[4:], uint32(len(dir)))
+	le.PutUint64(hdr[8:], offset)
+	w.Write(hdr[:16])
+	writeString16(w, root)
+	for _, doc := range docs {
+		writeString16(w, doc.Path)
+		le.PutUint64(hdr[0:], uint64(doc.Size))
+		le.PutUint64(hdr[8:], uint64(doc.ModTime))
+		w.Write(hdr[:16])
+	}
+	for _, e := range dir {
+		le.PutUint32(hdr[0:], e.Key)
+		le.PutUint32(hdr[4:], e.Docs)
+		le.PutUint64(hdr[8:], e.Offset)
+		w.Write(hdr[:trigramEntrySize])
+	}
+	for _, e := range dir {
+		w.Write(postings[e.Key].data)
+	}
+
+	if err := w.Flush(); err != nil {
+		f.Close()
+		os.Remove(tmp)
+		return 0, err
+	}
+	if err := f.Close(); err != nil {
+		os.Remove(tmp)
+		return 0, err
+	}
+	return len(docs), os.Rename(tmp, indexPath)
+}
+
+func writeString16(w *bufio.Writer, s string) {
+	var n [2]byte
+	binary.LittleEndian.PutUint16(n[:], uint16(len(s)))
+	w.Write(n[:])
+	w.WriteString(s)
+}
+
+func readString16(r *bufio.Reader) (string, error) {
+	var n [2]byte
+	if _, err := io.ReadFull(r, n[:]); err != nil {
+		return "", err
+	}
+	s := make([]byte, binary.LittleEndian.Uint16(n[:]))
+	_, err := io.ReadFull(r, s)
+	return string(s), err
+}
+
+// OpenTrigramIndex loads the document table and trigram directory
+func OpenTrigramIndex(indexPath string) (*TrigramIndex, error) {
+	f, err := os.Open(indexPath)
+	if err != nil {
+		return nil, err
+	}
+	ix, err := readTrigramIndex(f)
+	if err != nil {
+		f.Close()
+		return nil, fmt.Errorf("%s: %w", indexPath, err)
+	}
+	return ix, nil
+}
+
+func readTrigramIndex(f *os.File) (*TrigramIndex, error) {
+	r := bufio.NewReaderSize(f, 1<<20)
+	var hdr [24]byte
+	if _, err := io.ReadFull(r, hdr[:]); err != nil {
+		return nil, err
+	}
+	if string(hdr[:8]) != trigramMagic {
+		return nil, errors.New("not a trigram index")
+	}
+	le := binary.LittleEndian
+	docCount := le.Uint32(hdr[8:])
+	trigramCount := le.Uint32(hdr[12:])
+
+	ix := &TrigramIndex{file: f, Docs: make([]IndexedDoc, docCount), dir: make([]trigramEntry, trigramCount)}
+	read := int64(len(hdr))
+	root, err := readString16(r)
+	if err != nil {
+		return nil, err
+	}
+	ix.Root = root
+	read += 2 + int64(len(root))
+
+	var rec [16]byte
+	for i := range ix.Docs {
+		path, err := readString16(r)
+		if err != nil {
+			return nil, err
+		}
+		if _, err := io.ReadFull(r, rec[:]); err != nil {
+			return nil, err
+		}
+		ix.Docs[i] = IndexedDoc{Path: path, Size: int64(le.Uint64(rec[0:])), ModTime: int64(le.Uint64(rec[8:]))}
+		read += 2 + int64(len(path)) + 16
+	}
+	for i := range ix.dir {
+		if _, err := io.ReadFull(r, rec[:trigramEntrySize]); err != nil {
+			return nil, err
+		}
+		ix.dir[i] = trigramEntry{Key: le.Uint32(rec[0:]), Docs: le.Uint32(rec[4:]), Offset: le.Uint64(rec[8:])}
+	}
+	ix.postingsBase = read + int64(trigramCount)*trigramEntrySize
+	return ix, nil
+}
+
+// Close releases the index file
+func (ix *TrigramIndex) Close() error {
+	return ix.file.Close()
+}
+
+func (ix *TrigramIndex) lookup(key uint32) (trigramEntry, bool) {
+	i := sort.Search(len(ix.dir), func(i int) bool { return ix.dir[i].Key >= key })
+	if i < len(ix.dir) && ix.dir[i].Key == key {
+		return ix.dir[i], true
+	}
+	return trigramEntry{}, false
+}
+
+// postings reads and decodes one trigram's doc IDs
+func (ix *TrigramIndex) postings(e trigramEntry) ([]uint32, error) {
+	// A list runs up to the next trigram's offset or the end of the file
+	var size uint64
+	i := sort.Search(len(ix.dir), func(i int) bool { return ix.dir[i].Key > e.Key })
+	if i < len(ix.dir) {
+		size = ix.dir[i].Offset - e.Offset
+	} else {
+		info, err := ix.file.Stat()
+		if err != nil {
+			return nil, err
+		}
+		size = uint64(info.Size()-ix.postingsBase) - e.Offset
+	}
+
+	data := make([]byte, size)
+	if _, err := ix.file.ReadAt(data, ix.postingsBase+int64(e.Offset)); err != nil {
+		return nil, err
+	}
+	ids := make([]uint32, 0, e.Docs)
+	var id uint32
+	for len(data) > 0 {
+		delta, n := binary.Uvarint(data)
+		if n <= 0 {
+			return nil, errors.New("corrupt posting list")
+		}
+		id += uint32(delta)
+		ids = append(ids, id)
+		data = data[n:]
+	}
+	return ids, nil
+}
+
+// intersect keeps the IDs of a also present in b (both ascending)
+func intersect(a, b []uint32) []uint32 {
+	out := a[:0]
+	j := 0
+	for _, id := range a {
+		for j < len(b) && b[j] < id {
+			j++
+		}
+		if j < len(b) && b[j] == id {
+			out = append(out, id)
+		}
+	}
+	return out
+}
+
+// Candidates returns, in ascending order, the IDs of indexed documents that
+// may contain at least one of patterns. Patterns shorter than three bytes
+// cannot be filtered and make every document a candidate. Keys fold with
+// foldASCII, as PureMatcher does, so no document it would match is missed.
+func (ix *TrigramIndex) Candidates(patterns []string) ([]uint32, error) {
+	hit := make([]bool, len(ix.Docs))
+	cache := make(map[uint32][]uint32)
+
+	for _, pattern := range patterns {
+		if len(pattern) < 3 {
+			for i := range hit {
+				hit[i] = true
+			}
+			break
+		}
+
+		// Rarest trigram first keeps the running intersection small
+		var entries []trigramEntry
+		missing := false
+		for i := 0; i+2 < len(pattern) && !missing; i++ {
+			e, ok := ix.lookup(trigramKey(pattern[i], pattern[i+1], pattern[i+2]))
+			missing = !ok
+			entries = append(entries, e)
+		}
+		if missing {
+			continue
+		}
+		sort.Slice(entries, func(i, j int) bool {
+			if entries[i].Docs != entries[j].Docs {
+				return entries[i].Docs < entries[j].Docs
+			}
+			return entries[i].Key < entries[j].Key
+		})
+
+		var docs []uint32
+		for i, e := range entries {
+			if i > 0 && e.Key == entries[i-1].Key {
+				continue
+			}
+			ids, ok := cache[e.Key]
+			if !ok {
+				var err error
+				if ids, err = ix.postings(e); err != nil {
+					return nil, err
+				}
+				cache[e.Key] = ids
+			}
+			if i == 0 {
+				docs = append([]uint32(nil), ids...)
+			} else {
+				docs = intersect(docs, ids)
+			}
+			if len(docs) == 0 {
+				break
+			}
+		}
+		for _, id := range docs {
+			hit[id] = true
+		}
+	}
+
+	var ids []uint32
+	for id, ok := range hit {
+		if ok {
+			ids = append(ids, uint32(id))
+		}
+	}
+	return ids, nil
+}
+
+// SweepDoc is one scanned archive document with matches
+type SweepDoc struct {
+	Path    string
+	Matches []MatchResult
+}
+
+// SweepStats summarizes one sweep
+type SweepStats struct {
+	ArchiveDocs  int // Documents currently in the archive
+	Candidates   int // Documents the index could not rule out
+	Unindexed    int // New or modified since indexing (always scanned)
+	ScannedBytes int64
+	Elapsed      time.Duration
+}
+
+// Sweep scans only the documents that may contain patterns. Files added or
+// changed since the index was built are scanned unconditionally.
+func (ix *TrigramIndex) Sweep(patterns []string) ([]SweepDoc, SweepStats, error) {
+	start := time.Now()
+	var stats SweepStats
+
+	current, err := listArchive(ix.Root)
+	if err != nil {
+		return nil, stats, err
+	}
+	stats.ArchiveDocs = len(current)
+
+	indexed := make(map[string]IndexedDoc, len(ix.Docs))
+	for _, doc := range ix.Docs {
+		indexed[doc.Path] = doc
+	}
+	var paths []string
+	for _, doc := range current {
+		if old, ok := indexed[doc.Path]; !ok || old != doc {
+			paths = append(paths, doc.Path)
+			stats.Unindexed++
+		}
+	}
+
+	candidates, err := ix.Candidates(patterns)
+	if err != nil {
+		return nil, stats, err
+	}
+	stale := make(map[string]bool, len(paths))
+	for _, p := range paths {
+		stale[p] = true
+	}
+	live := make(map[string]bool, len(current))
+	for _, doc := range current {
+		live[doc.Path] = true
+	}
+	for _, id := range candidates {
+		p := ix.Docs[id].Path
+		if live[p] && !stale[p] {
+			paths = append(paths, p)
+		}
+	}
+	sort.Strings(paths)
+	stats.Candidates = len(paths)
+
+	matcher := NewPureMatcherWithPatterns(patterns)
+	found := make([]SweepDoc, len(paths))
+	sizes := make([]int64, len(paths))
+	errs := make([]error, len(paths))
+	next := make(chan int)
+	var wg sync.WaitGroup
+	for w := 0; w < runtime.GOMAXPROCS(0); w++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			for i := range next {
+				data, err := os.ReadFile(filepath.Join(ix.Root, filepath.FromSlash(paths[i])))
+				if err != nil {
+					errs[i] = err
+					continue
+				}
+				sizes[i] = int64(len(data))
+				found[i] = SweepDoc{Path: paths[i], Matches: matcher.SearchUncached(string(data))}
+			}
+		}()
+	}
+	for i := range paths {
+		next <- i
+	}
+	close(next)
+	wg.Wait()
+
+	var docs []SweepDoc
+	for i := range paths {
+		if errs[i] != nil {
+			return nil, stats, errs[i]
+		}
+		stats.ScannedBytes += sizes[i]
+		if len(found[i].Matches) > 0 {
+			docs = append(docs, found[i])
+		}
+	}
+	stats.Elapsed = time.Since(start)
+	return docs, stats, nil
+}
+
+// readPatternFile reads one pattern per line, skipping blanks and # comments
+func readPatternFile(path string) ([]string, error) {
+	data, err := os.ReadFile(path)
+	if err != nil {
+		return nil, err
+	}
+	var patterns []string
+	for _, line := range strings.Split(string(data), "\n") {
+		line = strings.TrimSpace(line)
+		if line != "" && !strings.HasPrefix(line, "#") {
+			patterns = append(patterns, line)
+		}
+	}
+	if len(patterns) == 0 {
+		return nil, fmt.Errorf("%s: no patterns", path)
+	}
+	return patterns, nil
+}
+
+// runIndex builds an index for the archive directory
+func runIndex(archive, indexPath string) error {
+	start := time.Now()
+	docs, err := BuildTrigramIndex(archive, indexPath)
+	if err != nil {
+		return err
+	}
+	fmt.Printf("🗂️  Indexed %d documents into %s (%v)\n", docs, indexPath, time.Since(start))
+	return nil
+}
+
+// runSweep matches a pattern file against the indexed archive
+func runSweep(indexPath, patternPath string) error {
+	patterns, err := readPatternFile(patternPath)
+	if err != nil {
+		return err
+	}
+	ix, err := OpenTrigramIndex(indexPath)
+	if err != nil {
+		return err
+	}
+	defer ix.Close()
+
+	docs, stats, err := ix.Sweep(patterns)
+	if err != nil {
+		return err
+	}
+
+	total := 0
+	for _, doc := range docs {
+		fmt.Printf("📄 %s: %d matches\n", doc.Path, len(doc.Matches))
+		total += len(doc.Matches)
+	}
+	share := 0.0
+	if stats.ArchiveDocs > 0 {
+		share = 100 * float64(stats.Candidates) / float64(stats.ArchiveDocs)
+	}
+	fmt.Printf("\n🔎 Sweep: %d patterns, scanned %d of %d documents (%.1f%%, %d unindexed), %d bytes\n",
+		len(patterns), stats.Candidates, stats.ArchiveDocs, share, stats.Unindexed, stats.ScannedBytes)
+	fmt.Printf("   %d matches in %d documents (%v)\n", total, len(docs), stats.Elapsed)
+	return nil
+}
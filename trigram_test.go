@@ -0,0 +1,55 @@
+package main
+
+import (
+	"os"
+	"path/filepath"
+	"testing"
+)
+
+// A sweep must find exactly what a full scan of the archive finds
+func TestSweepMatchesFullScan(t *testing.T) {
+	root := t.TempDir()
+	docs := map[string]string{
+		"a.txt": "Q: Did Émile say anything? A: ÉMILE SAID he was there.",
+		"b.txt": "the witness TOLD ME nothing",
+		"c.txt": "émile said it too, in lower case",
+		"d.txt": "nothing to see here",
+	}
+	for name, text := range docs {
+		if err := os.WriteFile(filepath.Join(root, name), []byte(text), 0o644); err != nil {
+			t.Fatal(err)
+		}
+	}
+	indexPath := filepath.Join(t.TempDir(), "archive.idx")
+	if _, err := BuildTrigramIndex(root, indexPath); err != nil {
+		t.Fatal(err)
+	}
+	ix, err := OpenTrigramIndex(indexPath)
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer ix.Close()
+
+	for _, patterns := range [][]string{
+		{"Émile said"},
+		{"ÉMILE SAID"},
+		{"émile said"},
+		{"told me", "he was"},
+		{"absent phrase"},
+	} {
+		found, _, err := ix.Sweep(patterns)
+		if err != nil {
+			t.Fatal(err)
+		}
+		got := make(map[string]int)
+		for _, d := range found {
+			got[d.Path] = len(d.Matches)
+		}
+		matcher := NewPureMatcherWithPatterns(patterns)
+		for name, text := range docs {
+			if want := len(matcher.SearchUncached(text)); got[name] != want {
+				t.Errorf("%q: sweep found %d matches in %s, full scan %d", patterns, got[name], name, want)
+			}
+		}
+	}
+}
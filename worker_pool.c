@@ -0,0 +1,724 @@
+#define _GNU_SOURCE
+#include "worker_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <immintrin.h>
+
+// Spins before a waiter falls back to yielding the CPU
+#define WAIT_SPIN_LIMIT 4096
+
+// Node-local copy of the compiled pattern database
+typedef struct {
+    matcher_state_t state;          // Search state pointing at the local copy
+    void* mapping;                  // Fresh pages, first touched on the node
+    size_t mapping_size;
+    atomic_int ready;               // 1 = built, -1 = allocation failed
+} pool_replica_t;
+
+// Worker counters; written only by the owning worker, read by anyone
+typedef struct {
+    atomic_int last_cpu;
+    atomic_uint_fast64_t jobs;
+    atomic_uint_fast64_t matches;
+    atomic_uint_fast64_t busy_cycles;
+    atomic_uint_fast64_t idle_polls;
+    atomic_uint_fast64_t sleeps;
+    atomic_uint_fast64_t migrations;
+} worker_counters_t;
+
+typedef struct {
+    matcher_pool_t* pool;
+    pthread_t thread;
+    uint32_t index;
+    uint32_t node;
+    int cpu;                        // Dedicated CPU from the affinity plan, or -1
+    bool pinned;                    // pthread_setaffinity_np succeeded for cpu
+    bool builds_replica;            // First worker on its node
+    matcher_state_t* db;            // Local replica or the shared state
+    matcher_scratch_t* scratch;     // Search arena, allocated after pinning
+    result_ring_t* ring;            // Streaming output (node-local pages)
+    size_t ring_bytes;
+    match_result_t* staging;        // Results staged before a bulk ring push
+    size_t staging_capacity;
+    _Alignas(64) worker_counters_t counters;
+} pool_worker_t;
+
+// Bounded MPMC queue slot (Vyukov sequence scheme)
+typedef struct {
+    atomic_size_t seq;
+    pool_job_t* job;
+} queue_cell_t;
+
+struct matcher_pool {
+    _Alignas(64) atomic_size_t enqueue_pos;
+    _Alignas(64) atomic_size_t dequeue_pos;
+    _Alignas(64) queue_cell_t* cells;
+    size_t queue_mask;
+
+    // Idle workers sleep here; submitters only signal when someone sleeps
+    pthread_mutex_t sleep_lock;
+    pthread_cond_t wake;
+    atomic_uint sleepers;
+    atomic_bool stopping;
+    atomic_uint started;
+
+    matcher_state_t* state;
+    pool_config_t cfg;
+    uint32_t node_count;
+    cpu_set_t node_cpus[POOL_MAX_NODES];        // Usable CPUs (affinity mask applied)
+    cpu_set_t node_all_cpus[POOL_MAX_NODES];    // Every CPU, including isolated ones
+    pool_replica_t replicas[POOL_MAX_NODES];
+    uint32_t worker_count;
+    pool_worker_t workers[POOL_MAX_WORKERS];
+};
+
+void pool_config_default(pool_config_t* cfg) {
+    cfg->workers_per_node = 0;
+    cfg->queue_capacity = 1024;
+    cfg->replicate_per_node = true;
+    cfg->pin_workers = true;
+    cfg->cpu_list = NULL;
+    cfg->use_isolated_cpus = false;
+    cfg->busy_poll = false;
+    cfg->result_ring_capacity = 0;
+}
+
+// Parse a kernel cpulist such as "0-3,8-11" into a CPU set
+static void parse_cpulist(const char* list, cpu_set_t* set) {
+    CPU_ZERO(set);
+    const char* p = list;
+    while (*p) {
+        char* end;
+        long first = strtol(p, &end, 10);
+        if (end == p) break;
+        long last = first;
+        p = end;
+        if (*p == '-') {
+            last = strtol(p + 1, &end, 10);
+            p = end;
+        }
+        for (long cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++) {
+            CPU_SET(cpu, set);
+        }
+        if (*p == ',') p++;
+        else break;
+    }
+}
+
+static bool read_cpulist(const char* path, cpu_set_t* set) {
+    char buf[1024];
+    FILE* f = fopen(path, "r");
+    if (!f) return false;
+    bool ok = fgets(buf, sizeof(buf), f) != NULL;
+    fclose(f);
+    if (ok) parse_cpulist(buf, set);
+    return ok;
+}
+
+// Group CPUs by NUMA node (sysfs, no libnuma). node_cpus keeps the CPUs this
+// process may run on; node_all_cpus keeps every CPU, since isolated cores
+// (isolcpus) are outside the inherited affinity mask but still need a node.
+static uint32_t detect_numa_nodes(cpu_set_t* node_cpus, cpu_set_t* node_all_cpus, uint32_t max_nodes) {
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        CPU_ZERO(&allowed);
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        for (long cpu = 0; cpu < n && cpu < CPU_SETSIZE; cpu++) CPU_SET(cpu, &allowed);
+    }
+
+    uint32_t count = 0;
+    cpu_set_t online;
+    if (read_cpulist("/sys/devices/system/node/online", &online)) {
+        for (int node = 0; node < CPU_SETSIZE && count < max_nodes; node++) {
+            if (!CPU_ISSET(node, &online)) continue;
+
+            char path[96];
+            snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+            cpu_set_t cpus;
+            if (!read_cpulist(path, &cpus)) continue;
+            if (CPU_COUNT(&cpus) == 0) continue;   // Memory-only node
+
+            node_all_cpus[count] = cpus;
+            CPU_AND(&node_cpus[count], &cpus, &allowed);
+            count++;
+        }
+    }
+
+    // No NUMA information: treat the machine as a single node
+    if (count == 0) {
+        node_cpus[0] = allowed;
+        CPU_ZERO(&node_all_cpus[0]);
+        long n = sysconf(_SC_NPROCESSORS_CONF);
+        for (long cpu = 0; cpu < n && cpu < CPU_SETSIZE; cpu++) CPU_SET(cpu, &node_all_cpus[0]);
+        CPU_OR(&node_all_cpus[0], &node_all_cpus[0], &allowed);
+        count = 1;
+    }
+    return count;
+}
+
+// Bounded MPMC queue
+static bool queue_push(matcher_pool_t* pool, pool_job_t* job) {
+    size_t pos = atomic_load_explicit(&pool->enqueue_pos, memory_order_relaxed);
+    for (;;) {
+        queue_cell_t* cell = &pool->cells[pos & pool->queue_mask];
+        size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&pool->enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                cell->job = job;
+                atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;   // Full
+        } else {
+            pos = atomic_load_explicit(&pool->enqueue_pos, memory_order_relaxed);
+        }
+    }
+}
+
+static pool_job_t* queue_pop(matcher_pool_t* pool) {
+    size_t pos = atomic_load_explicit(&pool->dequeue_pos, memory_order_relaxed);
+    for (;;) {
+        queue_cell_t* cell = &pool->cells[pos & pool->queue_mask];
+        size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&pool->dequeue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                pool_job_t* job = cell->job;
+                atomic_store_explicit(&cell->seq, pos + pool->queue_mask + 1, memory_order_release);
+                return job;
+            }
+        } else if (diff < 0) {
+            return NULL;    // Empty
+        } else {
+            pos = atomic_load_explicit(&pool->dequeue_pos, memory_order_relaxed);
+        }
+    }
+}
+
+// Busy-poll mode: never enter the kernel while waiting for work
+static pool_job_t* worker_poll_job(matcher_pool_t* pool, pool_worker_t* worker) {
+    uint64_t polls = 0;
+    for (;;) {
+        pool_job_t* job = queue_pop(pool);
+        if (job || atomic_load_explicit(&pool->stopping, memory_order_relaxed)) {
+            atomic_fetch_add_explicit(&worker->counters.idle_polls, polls, memory_order_relaxed);
+            return job;
+        }
+        polls++;
+        _mm_pause();
+    }
+}
+
+// Block until a job arrives; NULL means the pool is shutting down
+static pool_job_t* worker_next_job(matcher_pool_t* pool, pool_worker_t* worker) {
+    if (pool->cfg.busy_poll) {
+        return worker_poll_job(pool, worker);
+    }
+    for (;;) {
+        pool_job_t* job = queue_pop(pool);
+        if (job) return job;
+        if (atomic_load(&pool->stopping)) return NULL;
+
+        pthread_mutex_lock(&pool->sleep_lock);
+        atomic_fetch_add(&pool->sleepers, 1);
+        atomic_thread_fence(memory_order_seq_cst);
+        job = queue_pop(pool);
+        if (!job && !atomic_load(&pool->stopping)) {
+            atomic_fetch_add_explicit(&worker->counters.sleeps, 1, memory_order_relaxed);
+            pthread_cond_wait(&pool->wake, &pool->sleep_lock);
+        }
+        atomic_fetch_sub(&pool->sleepers, 1);
+        pthread_mutex_unlock(&pool->sleep_lock);
+        if (job) return job;
+    }
+}
+
+// Copy the compiled database into pages first touched by this thread. Under
+// the default first-touch policy they land on the caller's NUMA node.
+static int replica_build(pool_replica_t* replica, const matcher_state_t* src) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t size = (src->pattern_buffer_size + page - 1) & ~(page - 1);
+
+    void* mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED) return -1;
+    memcpy(mapping, src->pattern_buffer, src->pattern_buffer_size);
+
+    memcpy(&replica->state, src, sizeof(*src));
+    replica->state.pattern_buffer = mapping;
+    reset_performance_stats(&replica->state);
+    replica->mapping = mapping;
+    replica->mapping_size = size;
+    return 0;
+}
+
+// Scan a streaming job and publish its matches plus a RING_DOC_END marker.
+// The marker is sent even when the scan fails (offset RING_DOC_ERROR), since
+// the consumer holds the document until it sees it. A full ring applies
+// backpressure: the worker waits for the consumer.
+static int worker_stream_job(pool_worker_t* worker, pool_job_t* job) {
+    matcher_pool_t* pool = worker->pool;
+
+    int matches = -1;
+    if (job->max_results > worker->staging_capacity) {
+        match_result_t* grown = realloc(worker->staging, job->max_results * sizeof(match_result_t));
+        if (grown) {
+            worker->staging = grown;
+            worker->staging_capacity = job->max_results;
+        }
+    }
+    if (worker->scratch && job->max_results <= worker->staging_capacity) {
+        matches = search_patterns_scratch(worker->db, worker->scratch, job->text, job->text_len,
+                                          worker->staging, job->max_results);
+    }
+    size_t count = matches > 0 ? (size_t)matches : 0;
+
+    ring_match_t batch[64];
+    size_t next = 0;
+    bool end_sent = false;
+    while (!end_sent) {
+        size_t n = 0;
+        for (; next < count && n < 64; next++, n++) {
+            batch[n].doc_id = job->doc_id;
+            batch[n].offset = worker->staging[next].offset;
+            batch[n].pattern_id = worker->staging[next].pattern_id;
+            batch[n].length = (uint32_t)worker->staging[next].length;
+        }
+        if (next == count && n < 64) {
+            batch[n].doc_id = job->doc_id;
+            batch[n].offset = matches < 0 ? RING_DOC_ERROR : count;
+            batch[n].pattern_id = RING_DOC_END;
+            batch[n].length = 0;
+            n++;
+            end_sent = true;
+        }
+
+        size_t pushed = 0;
+        while (pushed < n) {
+            pushed += result_ring_push_bulk(worker->ring, batch + pushed, n - pushed);
+            if (pushed < n) {
+                if (atomic_load_explicit(&pool->stopping, memory_order_relaxed)) return matches;
+                if (pool->cfg.busy_poll) _mm_pause();
+                else sched_yield();
+            }
+        }
+    }
+    return matches;
+}
+
+static void* worker_main(void* arg) {
+    pool_worker_t* worker = arg;
+    matcher_pool_t* pool = worker->pool;
+
+    if (worker->cpu >= 0) {
+        cpu_set_t single;
+        CPU_ZERO(&single);
+        CPU_SET(worker->cpu, &single);
+        int rc = pthread_setaffinity_np(pthread_self(), sizeof(single), &single);
+        worker->pinned = rc == 0;
+        if (rc != 0) {
+            fprintf(stderr, "⚠️  Worker %u: cannot pin to CPU %d: %s\n", worker->index, worker->cpu, strerror(rc));
+        }
+    } else if (pool->cfg.pin_workers) {
+        int rc = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &pool->node_cpus[worker->node]);
+        if (rc != 0) {
+            fprintf(stderr, "⚠️  Worker %u: cannot pin to node %u: %s\n", worker->index, worker->node, strerror(rc));
+        }
+    }
+    atomic_store_explicit(&worker->counters.last_cpu, sched_getcpu(), memory_order_relaxed);
+
+    if (pool->cfg.replicate_per_node) {
+        pool_replica_t* replica = &pool->replicas[worker->node];
+        if (worker->builds_replica) {
+            int rc = replica_build(replica, pool->state);
+            atomic_store_explicit(&replica->ready, rc == 0 ? 1 : -1, memory_order_release);
+        }
+        int ready;
+        while ((ready = atomic_load_explicit(&replica->ready, memory_order_acquire)) == 0) {
+            sched_yield();
+        }
+        // Fall back to the shared copy if the node could not get its own
+        worker->db = ready > 0 ? &replica->state : pool->state;
+    } else {
+        worker->db = pool->state;
+    }
+
+    // Allocated after pinning so scratch and ring pages are local to this worker
+    worker->scratch = matcher_scratch_alloc();
+    if (pool->cfg.result_ring_capacity > 0) {
+        uint64_t capacity = 2;
+        while (capacity < pool->cfg.result_ring_capacity) capacity <<= 1;
+        size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        size_t bytes = (result_ring_bytes(capacity) + page - 1) & ~(page - 1);
+        void* mapping = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapping != MAP_FAILED) {
+            worker->ring = mapping;
+            worker->ring_bytes = bytes;
+            result_ring_init(worker->ring, capacity);
+        }
+    }
+    atomic_fetch_add(&pool->started, 1);
+
+    worker_counters_t* counters = &worker->counters;
+    pool_job_t* job;
+    while ((job = worker_next_job(pool, worker)) != NULL) {
+        uint64_t start = get_cpu_cycles();
+        int matches;
+        if (!job->results) {
+            // Rings exist on every worker whenever streaming is enabled
+            matches = worker->ring ? worker_stream_job(worker, job) : -1;
+        } else if (!worker->scratch) {
+            matches = -1;   // Scratch allocation failed at startup
+        } else {
+            matches = search_patterns_scratch(worker->db, worker->scratch, job->text, job->text_len,
+                                              job->results, job->max_results);
+        }
+        uint64_t end = get_cpu_cycles_end();
+        job->match_count = matches;
+        atomic_store_explicit(&job->done, true, memory_order_release);
+
+        atomic_fetch_add_explicit(&counters->jobs, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&counters->matches, matches > 0 ? matches : 0, memory_order_relaxed);
+        atomic_fetch_add_explicit(&counters->busy_cycles, end - start, memory_order_relaxed);
+
+        // A pinned worker should never move; count it if the kernel disagrees
+        int cpu = sched_getcpu();
+        if (cpu != atomic_load_explicit(&counters->last_cpu, memory_order_relaxed)) {
+            atomic_fetch_add_explicit(&counters->migrations, 1, memory_order_relaxed);
+            atomic_store_explicit(&counters->last_cpu, cpu, memory_order_relaxed);
+        }
+    }
+    return NULL;
+}
+
+// Resolve the configured affinity plan; false means "no plan, use nodes"
+static bool affinity_plan(const pool_config_t* cfg, cpu_set_t* plan) {
+    if (cfg->cpu_list && cfg->cpu_list[0]) {
+        parse_cpulist(cfg->cpu_list, plan);
+        return true;
+    }
+    if (cfg->use_isolated_cpus) {
+        // Cores removed from the scheduler with isolcpus=; an empty list
+        // means nothing was isolated, so fall back to the node layout
+        if (read_cpulist("/sys/devices/system/cpu/isolated", plan) && CPU_COUNT(plan) > 0) {
+            return true;
+        }
+        fprintf(stderr, "⚠️  No isolated CPUs found, using NUMA node layout\n");
+    }
+    return false;
+}
+
+// Searches the unmasked cpulists, so isolated cores map to their own node
+static uint32_t node_of_cpu(const matcher_pool_t* pool, int cpu) {
+    for (uint32_t node = 0; node < pool->node_count; node++) {
+        if (CPU_ISSET(cpu, &pool->node_all_cpus[node])) return node;
+    }
+    return 0;   // Offline or unknown CPU: attribute to the first node
+}
+
+static void add_worker(matcher_pool_t* pool, uint32_t node, int cpu) {
+    if (pool->worker_count >= POOL_MAX_WORKERS) return;
+
+    bool node_has_worker = false;
+    for (uint32_t i = 0; i < pool->worker_count; i++) {
+        if (pool->workers[i].node == node) node_has_worker = true;
+    }
+
+    pool_worker_t* worker = &pool->workers[pool->worker_count];
+    worker->pool = pool;
+    worker->index = pool->worker_count;
+    worker->node = node;
+    worker->cpu = cpu;
+    worker->builds_replica = !node_has_worker;
+    pool->worker_count++;
+}
+
+// One worker per planned CPU, each pinned to exactly that CPU
+static void layout_planned_workers(matcher_pool_t* pool, const cpu_set_t* plan) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (CPU_ISSET(cpu, plan)) add_worker(pool, node_of_cpu(pool, cpu), cpu);
+    }
+}
+
+// workers_per_node workers per node, free to run anywhere on their node
+static void layout_node_workers(matcher_pool_t* pool) {
+    for (uint32_t node = 0; node < pool->node_count; node++) {
+        uint32_t per_node = pool->cfg.workers_per_node;
+        if (CPU_COUNT(&pool->node_cpus[node]) == 0) continue;   // Every CPU excluded or isolated
+        if (per_node == 0) per_node = (uint32_t)CPU_COUNT(&pool->node_cpus[node]);
+        for (uint32_t i = 0; i < per_node; i++) add_worker(pool, node, -1);
+    }
+}
+
+matcher_pool_t* matcher_pool_create(matcher_state_t* state, const pool_config_t* cfg) {
+    if (!state->initialized) return NULL;
+
+    matcher_pool_t* pool = aligned_alloc_64(sizeof(*pool));
+    if (!pool) return NULL;
+    memset(pool, 0, sizeof(*pool));
+
+    pool->state = state;
+    if (cfg) {
+        pool->cfg = *cfg;
+    } else {
+        pool_config_default(&pool->cfg);
+    }
+
+    size_t capacity = 2;
+    while (capacity < pool->cfg.queue_capacity) capacity <<= 1;
+    pool->cells = aligned_alloc_64(capacity * sizeof(queue_cell_t));
+    if (!pool->cells) {
+        aligned_free(pool);
+        return NULL;
+    }
+    pool->queue_mask = capacity - 1;
+    for (size_t i = 0; i < capacity; i++) {
+        atomic_store_explicit(&pool->cells[i].seq, i, memory_order_relaxed);
+    }
+
+    pthread_mutex_init(&pool->sleep_lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+
+    pool->node_count = detect_numa_nodes(pool->node_cpus, pool->node_all_cpus, POOL_MAX_NODES);
+
+    cpu_set_t plan;
+    if (affinity_plan(&pool->cfg, &plan)) {
+        layout_planned_workers(pool, &plan);
+    } else {
+        layout_node_workers(pool);
+    }
+    if (pool->worker_count == 0) {
+        matcher_pool_destroy(pool);
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < pool->worker_count; i++) {
+        if (pthread_create(&pool->workers[i].thread, NULL, worker_main, &pool->workers[i]) != 0) {
+            // Keep the workers that did start; the queue serves them all
+            pool->worker_count = i;
+            break;
+        }
+    }
+    if (pool->worker_count == 0) {
+        matcher_pool_destroy(pool);
+        return NULL;
+    }
+
+    while (atomic_load(&pool->started) < pool->worker_count) {
+        sched_yield();
+    }
+
+    // A streamed document sent to a worker without a ring would never end
+    if (pool->cfg.result_ring_capacity > 0) {
+        for (uint32_t i = 0; i < pool->worker_count; i++) {
+            if (!pool->workers[i].ring) {
+                matcher_pool_destroy(pool);
+                return NULL;
+            }
+        }
+    }
+
+    printf("🧵 Worker pool: %u workers on %u NUMA node(s), replicas: %s, busy-poll: %s\n",
+           pool->worker_count, pool->node_count, pool->cfg.replicate_per_node ? "YES" : "NO",
+           pool->cfg.busy_poll ? "YES" : "NO");
+    return pool;
+}
+
+void matcher_pool_destroy(matcher_pool_t* pool) {
+    if (!pool) return;
+
+    pthread_mutex_lock(&pool->sleep_lock);
+    atomic_store(&pool->stopping, true);
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->sleep_lock);
+
+    for (uint32_t i = 0; i < pool->worker_count; i++) {
+        pthread_join(pool->workers[i].thread, NULL);
+    }
+
+    for (uint32_t i = 0; i < pool->worker_count; i++) {
+        if (pool->workers[i].ring) munmap(pool->workers[i].ring, pool->workers[i].ring_bytes);
+        free(pool->workers[i].staging);
+        matcher_scratch_free(pool->workers[i].scratch);
+    }
+
+    for (uint32_t node = 0; node < pool->node_count; node++) {
+        if (pool->replicas[node].mapping) {
+            munmap(pool->replicas[node].mapping, pool->replicas[node].mapping_size);
+        }
+    }
+
+    pthread_cond_destroy(&pool->wake);
+    pthread_mutex_destroy(&pool->sleep_lock);
+    aligned_free(pool->cells);
+    aligned_free(pool);
+}
+
+int matcher_pool_submit(matcher_pool_t* pool, pool_job_t* job) {
+    atomic_store_explicit(&job->done, false, memory_order_relaxed);
+    job->match_count = 0;
+    if (!queue_push(pool, job)) {
+        return -1;
+    }
+
+    // Pairs with the fence in worker_next_job: either the worker sees the
+    // job on its re-check or we see it sleeping and wake it
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load(&pool->sleepers) > 0) {
+        pthread_mutex_lock(&pool->sleep_lock);
+        pthread_cond_signal(&pool->wake);
+        pthread_mutex_unlock(&pool->sleep_lock);
+    }
+    return 0;
+}
+
+void matcher_pool_wait(pool_job_t* job) {
+    uint32_t spins = 0;
+    while (!atomic_load_explicit(&job->done, memory_order_acquire)) {
+        if (++spins < WAIT_SPIN_LIMIT) {
+            _mm_pause();
+        } else {
+            sched_yield();
+        }
+    }
+}
+
+int matcher_pool_search_batch(matcher_pool_t* pool, pool_job_t* jobs, size_t job_count) {
+    for (size_t i = 0; i < job_count; i++) {
+        while (matcher_pool_submit(pool, &jobs[i]) != 0) {
+            sched_yield();  // Queue full: let workers drain it
+        }
+    }
+
+    // Wait for every job even after a failure: the caller owns their memory
+    int total = 0;
+    bool failed = false;
+    for (size_t i = 0; i < job_count; i++) {
+        matcher_pool_wait(&jobs[i]);
+        if (jobs[i].match_count < 0) failed = true;
+        else total += jobs[i].match_count;
+    }
+    return failed ? -1 : total;
+}
+
+int matcher_pool_search_parallel(
+    matcher_pool_t* pool,
+    const char* text,
+    size_t text_len,
+    match_result_t* results,
+    size_t max_results
+) {
+    size_t chunk_size = pool->state->tuning.parallel_chunk_size;
+    if (text_len <= chunk_size || pool->worker_count == 1) {
+        return search_patterns(pool->state, text, text_len, results, max_results);
+    }
+
+    // Chunks overlap by max_pattern_len - 1 so boundary-straddling matches
+    // are found; each chunk keeps only matches that start inside it. Every
+    // chunk also sees one byte of context on each side, so the whole-word
+    // check compares against the real neighbours instead of a chunk edge.
+    size_t overlap = pool->state->max_pattern_len ? pool->state->max_pattern_len - 1 : 0;
+    size_t chunk_count = (text_len + chunk_size - 1) / chunk_size;
+
+    pool_job_t* jobs = calloc(chunk_count, sizeof(pool_job_t));
+    match_result_t* scratch = malloc(chunk_count * max_results * sizeof(match_result_t));
+    if (!jobs || !scratch) {
+        free(jobs);
+        free(scratch);
+        return -1;
+    }
+
+    for (size_t c = 0; c < chunk_count; c++) {
+        size_t start = c * chunk_size;
+        size_t end = start + chunk_size + overlap + 1;
+        if (end > text_len) end = text_len;
+        size_t lead = start > 0 ? 1 : 0;
+
+        jobs[c].text = text + start - lead;
+        jobs[c].text_len = end - start + lead;
+        jobs[c].results = scratch + c * max_results;
+        jobs[c].max_results = max_results;
+        jobs[c].doc_id = c;
+    }
+    if (matcher_pool_search_batch(pool, jobs, chunk_count) < 0) {
+        free(scratch);
+        free(jobs);
+        return -1;  // A chunk failed; partial results would look complete
+    }
+
+    // Merge in chunk order, rebasing offsets and dropping context matches
+    size_t match_count = 0;
+    for (size_t c = 0; c < chunk_count && match_count < max_results; c++) {
+        size_t start = c * chunk_size;
+        size_t lead = start > 0 ? 1 : 0;
+        for (int i = 0; i < jobs[c].match_count && match_count < max_results; i++) {
+            match_result_t match = jobs[c].results[i];
+            if (match.offset < lead || match.offset - lead >= chunk_size) continue;
+            match.offset += start - lead;
+            results[match_count++] = match;
+        }
+    }
+
+    free(scratch);
+    free(jobs);
+    return (int)match_count;
+}
+
+result_ring_t* matcher_pool_result_ring(const matcher_pool_t* pool, uint32_t worker) {
+    if (worker >= pool->worker_count) return NULL;
+    return pool->workers[worker].ring;
+}
+
+uint32_t matcher_pool_worker_count(const matcher_pool_t* pool) {
+    return pool->worker_count;
+}
+
+uint32_t matcher_pool_node_count(const matcher_pool_t* pool) {
+    return pool->node_count;
+}
+
+// Sum counters from the shared state and every node replica
+void matcher_pool_get_stats(matcher_pool_t* pool, perf_stats_t* stats) {
+    get_performance_stats(pool->state, stats);
+    if (!pool->cfg.replicate_per_node) return;
+
+    for (uint32_t node = 0; node < pool->node_count; node++) {
+        if (atomic_load(&pool->replicas[node].ready) <= 0) continue;
+
+        perf_stats_t local;
+        get_performance_stats(&pool->replicas[node].state, &local);
+        stats->total_searches += local.total_searches;
+        stats->total_matches += local.total_matches;
+        stats->cache_hits += local.cache_hits;
+        stats->cache_misses += local.cache_misses;
+        stats->simd_operations += local.simd_operations;
+        stats->fallback_operations += local.fallback_operations;
+        stats->total_cycles += local.total_cycles;
+        stats->invalid_utf8 += local.invalid_utf8;
+    }
+}
+
+int matcher_pool_get_worker_stats(const matcher_pool_t* pool, uint32_t index, pool_worker_stats_t* stats) {
+    if (index >= pool->worker_count) return -1;
+
+    const pool_worker_t* worker = &pool->workers[index];
+    const worker_counters_t* counters = &worker->counters;
+    stats->node = worker->node;
+    stats->pinned_cpu = worker->pinned ? worker->cpu : -1;
+    stats->last_cpu = atomic_load_explicit(&counters->last_cpu, memory_order_relaxed);
+    stats->jobs = atomic_load_explicit(&counters->jobs, memory_order_relaxed);
+    stats->matches = atomic_load_explicit(&counters->matches, memory_order_relaxed);
+    stats->busy_cycles = atomic_load_explicit(&counters->busy_cycles, memory_order_relaxed);
+    stats->idle_polls = atomic_load_explicit(&counters->idle_polls, memory_order_relaxed);
+    stats->sleeps = atomic_load_explicit(&counters->sleeps, memory_order_relaxed);
+    stats->migrations = atomic_load_explicit(&counters->migrations, memory_order_relaxed);
+    return 0;
+}
@@ -0,0 +1,89 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include "matcher.h"
+#include "result_ring.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define POOL_MAX_NODES   64
+#define POOL_MAX_WORKERS 256
+
+// One document (or document chunk) to scan
+typedef struct {
+    const char* text;               // Input text (must outlive the job)
+    size_t text_len;                // Text length in bytes
+    match_result_t* results;        // Output buffer (NULL = stream to result ring)
+    size_t max_results;             // Result cap per document
+    uint64_t doc_id;                // Caller-defined document identifier
+    int match_count;                // Matches written (valid once done)
+    atomic_bool done;               // Set by the worker on completion
+} pool_job_t;
+
+// Worker pool configuration
+typedef struct {
+    uint32_t workers_per_node;      // 0 = one per usable CPU on the node
+    uint32_t queue_capacity;        // Submission slots (rounded to power of two)
+    bool replicate_per_node;        // Node-local copy of the compiled patterns
+    bool pin_workers;               // Restrict each worker to its node's CPUs
+    const char* cpu_list;           // Affinity plan, e.g. "2-5,8": one worker per CPU
+    bool use_isolated_cpus;         // Plan from /sys/devices/system/cpu/isolated
+    bool busy_poll;                 // Spin on the queue instead of sleeping
+    uint32_t result_ring_capacity;  // Records per worker ring (0 = no rings)
+} pool_config_t;
+
+// Per-worker counters for verifying placement and polling behaviour
+typedef struct {
+    uint32_t node;                  // NUMA node the worker serves
+    int32_t pinned_cpu;             // Dedicated CPU, or -1 when node-wide or pinning failed
+    int32_t last_cpu;               // CPU observed after the latest job
+    uint64_t jobs;                  // Jobs completed
+    uint64_t matches;               // Matches reported
+    uint64_t busy_cycles;           // TSC cycles spent scanning
+    uint64_t idle_polls;            // Empty queue polls (busy-poll mode)
+    uint64_t sleeps;                // Condition-variable waits
+    uint64_t migrations;            // Observed CPU changes between jobs
+} pool_worker_stats_t;
+
+typedef struct matcher_pool matcher_pool_t;
+
+// Pool lifecycle
+void pool_config_default(pool_config_t* cfg);
+matcher_pool_t* matcher_pool_create(matcher_state_t* state, const pool_config_t* cfg);
+void matcher_pool_destroy(matcher_pool_t* pool);
+
+// Job submission (non-blocking; returns -1 when the queue is full)
+int matcher_pool_submit(matcher_pool_t* pool, pool_job_t* job);
+void matcher_pool_wait(pool_job_t* job);
+
+// Scan a batch of documents; returns the total match count, or -1 if any
+// job failed (per-job counts stay in match_count)
+int matcher_pool_search_batch(matcher_pool_t* pool, pool_job_t* jobs, size_t job_count);
+
+// Split one large text into cache-sized chunks scanned in parallel;
+// returns -1 if any chunk fails, like search_patterns
+int matcher_pool_search_parallel(
+    matcher_pool_t* pool,
+    const char* text,
+    size_t text_len,
+    match_result_t* results,
+    size_t max_results
+);
+
+// Per-worker result rings for jobs submitted with results == NULL. Each ring
+// has exactly one producer (its worker) and must have exactly one consumer.
+result_ring_t* matcher_pool_result_ring(const matcher_pool_t* pool, uint32_t worker);
+
+// Pool diagnostics
+uint32_t matcher_pool_worker_count(const matcher_pool_t* pool);
+uint32_t matcher_pool_node_count(const matcher_pool_t* pool);
+void matcher_pool_get_stats(matcher_pool_t* pool, perf_stats_t* stats);
+int matcher_pool_get_worker_stats(const matcher_pool_t* pool, uint32_t index, pool_worker_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WORKER_POOL_H
@@ -0,0 +1,128 @@
+#include "wu_manber.h"
+#include "roaring.h"
+#include <immintrin.h>
+
+typedef struct {
+    const pattern_table_t* table;
+    const uint8_t* text;
+    size_t text_len;
+    bool whole_words;
+    match_result_t* results;
+    size_t max_results;
+    uint64_t match_count;
+} wm_scan_t;
+
+// Patterns whose window ends at end with this last-block hash
+static void verify_window(wm_scan_t* scan, size_t end, uint32_t hash) {
+    const pattern_table_t* table = scan->table;
+    const uint32_t* buckets = pt_wm_buckets(table);
+    const uint32_t* ids = pt_wm_ids(table);
+    const uint16_t* lengths = pt_lengths(table);
+    size_t start = end + 1 - table->wm_window;
+
+    for (uint32_t k = buckets[hash]; k < buckets[hash + 1]; k++) {
+        uint32_t id = ids[k];
+        size_t length = lengths[id];
+        if (length > scan->text_len - start) continue;
+        if (!folded_equal(scan->text + start, pt_pattern(table, id), length)) continue;
+        if (scan->whole_words && !word_bounded(scan->text, scan->text_len, start, length)) continue;
+        if (scan->match_count >= scan->max_results) return;
+
+        match_result_t* match = &scan->results[scan->match_count++];
+        match->offset = start;
+        match->length = length;
+        match->pattern_id = id;
+        match->confidence = 95; // Fixed confidence for demo
+    }
+}
+
+// Zero-extended, case-folded bytes text[p .. p + 8) in 32-bit lanes
+static inline __m256i load_folded_lanes(const uint8_t* p) {
+    __m256i bytes = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)p));
+    __m256i offset = _mm256_sub_epi32(bytes, _mm256_set1_epi32('A'));
+    __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi32(_mm256_set1_epi32(26), offset),
+                                     _mm256_cmpgt_epi32(offset, _mm256_set1_epi32(-1)));
+    return _mm256_or_si256(bytes, _mm256_and_si256(upper, _mm256_set1_epi32(0x20)));
+}
+
+static inline uint32_t horizontal_max_epu32(__m256i v) {
+    __m128i m = _mm_max_epu32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    m = _mm_max_epu32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(1, 0, 3, 2)));
+    m = _mm_max_epu32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(2, 3, 0, 1)));
+    return (uint32_t)_mm_cvtsi128_si32(m);
+}
+
+uint64_t wm_search(
+    const pattern_table_t* table,
+    bool whole_words,
+    const char* text,
+    size_t text_len,
+    match_result_t* results,
+    size_t max_results
+) {
+    if (table->wm_block == 0 || text_len < table->wm_window) return 0;
+
+    wm_scan_t scan = {
+        .table = table,
+        .text = (const uint8_t*)text,
+        .text_len = text_len,
+        .whole_words = whole_words,
+        .results = results,
+        .max_results = max_results,
+        .match_count = 0,
+    };
+    const uint8_t* shift = pt_wm_shift(table);
+    const uint8_t* bytes = scan.text;
+    uint32_t block = table->wm_block;
+    uint32_t bits = table->wm_hash_bits;
+
+    const __m256i hash_mask = _mm256_set1_epi32((int)((1u << bits) - 1));
+    const __m256i byte_mask = _mm256_set1_epi32(0xff);
+    const __m256i lane_index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    size_t end = table->wm_window - 1;
+
+    // Eight window ends per step while their blocks are fully in the text
+    while (end + 8 <= text_len && scan.match_count < max_results) {
+        const uint8_t* last = bytes + end;
+        __m256i hash = load_folded_lanes(last - block + 1);
+        for (uint32_t i = 1; i < block; i++) {
+            hash = _mm256_xor_si256(_mm256_slli_epi32(hash, 5), load_folded_lanes(last - block + 1 + i));
+        }
+        hash = _mm256_and_si256(hash, hash_mask);
+
+        // Byte table gathered as dwords (padded by 4 bytes) and masked
+        __m256i shifts = _mm256_and_si256(_mm256_i32gather_epi32((const int*)shift, hash, 1), byte_mask);
+        uint32_t zero = (uint32_t)_mm256_movemask_ps(
+            _mm256_castsi256_ps(_mm256_cmpeq_epi32(shifts, _mm256_setzero_si256())));
+
+        if (zero) {
+            uint32_t hashes[8];
+            _mm256_storeu_si256((__m256i*)hashes, hash);
+            while (zero) {
+                unsigned lane = (unsigned)_tzcnt_u32(zero);
+                zero &= zero - 1;
+                verify_window(&scan, end + lane, hashes[lane]);
+            }
+        }
+
+        // Every end below end + j + shift_j is ruled out, and so is the
+        // whole vector
+        uint32_t reach = horizontal_max_epu32(_mm256_add_epi32(shifts, lane_index));
+        end += reach > 8 ? reach : 8;
+    }
+
+    // Scalar tail
+    while (end < text_len && scan.match_count < max_results) {
+        uint8_t folded[3];
+        for (uint32_t i = 0; i < block; i++) folded[i] = fold_byte(bytes[end - block + 1 + i]);
+        uint32_t hash = wm_block_hash(folded, block, bits);
+        uint8_t distance = shift[hash];
+        if (distance == 0) {
+            verify_window(&scan, end, hash);
+            distance = 1;
+        }
+        end += distance;
+    }
+
+    return scan.match_count;
+}
@@ -0,0 +1,35 @@
+#ifndef WU_MANBER_H
+#define WU_MANBER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "matcher.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Auto-select when every pattern is this long; the built-in set has 7-byte
+// patterns, so only custom lexicons (matcher_init_patterns) qualify
+#define WM_AUTO_MIN_LENGTH   12
+
+// Wu-Manber scan: slide a window of the table's wm_window bytes and look up
+// the folded block ending it in the shift table. Eight consecutive window
+// ends are hashed and their shifts gathered per AVX2 step. Zero-shift lanes
+// are verified against their bucket; otherwise the scan jumps to
+// max(end + 8, max_j(end + j + shift_j)). Results come out in offset order.
+uint64_t wm_search(
+    const pattern_table_t* table,
+    bool whole_words,
+    const char* text,
+    size_t text_len,
+    match_result_t* results,
+    size_t max_results
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WU_MANBER_H